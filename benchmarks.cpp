@@ -0,0 +1,481 @@
+// Microbenchmarks dos trechos quentes dos quatro programas, isolados, com
+// entradas fixas (mesmas sementes em toda execução) e tamanhos
+// parametrizados. Para cada caso: ns por operação, alocações e bytes
+// alocados por operação. A saída em CSV ou JSON serve para comparar dois
+// commits.
+//
+// Usa só os cabeçalhos sem dependência de plataforma (nada de console do
+// Windows, SDL, olcConsoleGameEngine ou raylib):
+//
+//     g++ -std=c++17 -O2 -pthread benchmarks.cpp -o benchmarks
+//     ./benchmarks [--filter TEXTO] [--min-time MS] [--format table|csv|json] [--out ARQUIVO]
+
+#include <atomic>      // Contadores de alocação.
+#include <chrono>      // Relógio estável para medir cada caso.
+#include <cmath>       // Senos e cossenos do rotate() antigo.
+#include <cstdint>     // Tipos inteiros de tamanho fixo.
+#include <cstdio>      // printf e a saída em arquivo.
+#include <cstdlib>     // malloc/free do operator new substituído, atof.
+#include <deque>       // Corpo da cobra como era antes (referência).
+#include <functional>  // Corpo de cada caso.
+#include <new>         // operator new/delete substituídos.
+#include <string>
+#include <vector>
+using namespace std;
+
+#include "consolefps_map.h"      // Mapa em bits com níveis de blocos vazios.
+#include "consolefps_raycast.h"  // Lançamento de raios (passo fixo, DDA e saltos).
+#include "rotatingcube_mesh.h"   // mat3, vertexArray, transformScalar e transform.
+#include "rotatingcube_raster.h" // Framebuffer::line.
+#include "flappybird_sim.h"      // Passo da simulação do Flappy Bird.
+#include "snake_sim.h"           // Regras da cobra sem raylib.
+
+// Alocações feitas desde o início do programa. O operator new global é
+// substituído para contar; o caso mede a diferença antes e depois.
+static atomic<long long> nAllocCount{0};
+static atomic<long long> nAllocBytes{0};
+
+void* operator new(size_t nSize) {
+    nAllocCount.fetch_add(1, memory_order_relaxed);
+    nAllocBytes.fetch_add((long long)nSize, memory_order_relaxed);
+    if (void* p = malloc(nSize ? nSize : 1))
+        return p;
+    throw bad_alloc();
+}
+
+void operator delete(void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+
+// Impede o compilador de descartar um resultado que ninguém lê.
+static volatile uint64_t nSink = 0;
+
+inline void Consume(uint64_t x) { nSink = nSink + x; }
+
+// Gerador fixo para montar as entradas (mesma sequência em toda execução).
+struct BenchRandom {
+    uint32_t nState;
+
+    explicit BenchRandom(uint32_t nSeed) : nState(nSeed * 2654435761u | 1u) {}
+
+    uint32_t Next() {
+        nState ^= nState << 13;
+        nState ^= nState >> 17;
+        nState ^= nState << 5;
+        return nState;
+    }
+
+    float Unit() { return (Next() >> 8) * (1.0f / 16777216.0f); }
+};
+
+struct BenchResult {
+    string sName;        // Programa/trecho
+    string sParam;       // Tamanho ou variante
+    long long nOps;      // Operações medidas
+    double fNsPerOp;
+    double fAllocsPerOp;
+    double fBytesPerOp;
+};
+
+// Roda um caso com cada vez mais operações até passar de fMinSeconds e
+// guarda a última rodada. O corpo recebe quantas operações fazer.
+class BenchRunner {
+public:
+    string sFilter;
+    double fMinSeconds = 0.2;
+    vector<BenchResult> results;
+
+    void Run(const string& sName, const string& sParam, const function<void(long long)>& body) {
+        if (!sFilter.empty() && (sName + " " + sParam).find(sFilter) == string::npos)
+            return;
+        body(1); // Aquece caches e alocações preguiçosas
+        long long nOps = 1;
+        while (true) {
+            long long nAllocs0 = nAllocCount.load(), nBytes0 = nAllocBytes.load();
+            auto tp1 = chrono::steady_clock::now();
+            body(nOps);
+            auto tp2 = chrono::steady_clock::now();
+            // Lê os contadores antes de copiar os nomes, que também alocam
+            long long nAllocs = nAllocCount.load() - nAllocs0, nBytes = nAllocBytes.load() - nBytes0;
+            double fSeconds = chrono::duration<double>(tp2 - tp1).count();
+            if (fSeconds >= fMinSeconds || nOps >= (1ll << 40)) {
+                results.push_back({ sName, sParam, nOps, fSeconds * 1e9 / nOps,
+                                    (double)nAllocs / nOps, (double)nBytes / nOps });
+                return;
+            }
+            // Estima quantas operações enchem o tempo mínimo, com folga
+            double fScale = fSeconds > 0 ? fMinSeconds / fSeconds * 1.2 : 10.0;
+            nOps = (long long)(nOps * (fScale < 10.0 ? (fScale > 2.0 ? fScale : 2.0) : 10.0));
+        }
+    }
+};
+
+// ---------------------------------------------------------------------------
+// consolefps: um raio por coluna da tela
+
+// Mapa quadrado com borda de paredes e pilares espalhados, centro livre
+// (como o do --bench-raycast do jogo). nSize 16 sem pilares é o mapa do jogo.
+wstring MakeFpsMap(int nSize, float fDensity, uint32_t nSeed) {
+    BenchRandom rng(nSeed);
+    wstring map((size_t)nSize * nSize, L'.');
+    for (int y = 0; y < nSize; y++)
+        for (int x = 0; x < nSize; x++)
+            if (x == 0 || y == 0 || x == nSize - 1 || y == nSize - 1 || rng.Unit() < fDensity)
+                map[(size_t)y * nSize + x] = L'#';
+    map[(size_t)(nSize / 2) * nSize + nSize / 2] = L'.';
+    return map;
+}
+
+void BenchConsoleFps(BenchRunner& runner) {
+    const int nColumns = 120;
+    const float fFOV = 3.14159f / 4.0f;
+    struct Case { int nSize; float fDensity; };
+    for (Case c : { Case{ 16, 0.0f }, Case{ 256, 0.02f }, Case{ 1024, 0.002f } }) {
+        GameMap map;
+        map.Assign(MakeFpsMap(c.nSize, c.fDensity, 7), c.nSize, c.nSize);
+        float fPosX = c.nSize / 2 + 0.5f, fPosY = c.nSize / 2 + 0.5f;
+        float fDepth = c.nSize < 16 ? 16.0f : (float)c.nSize;
+
+        // Direções dos raios de 8 vistas girando em torno do jogador
+        vector<float> eyeX, eyeY;
+        for (int v = 0; v < 8; v++) {
+            float fAngle = v * 0.785f;
+            for (int x = 0; x < nColumns; x++) {
+                float fRayAngle = (fAngle - fFOV / 2.0f) + ((float)x / (float)nColumns) * fFOV;
+                eyeX.push_back(sinf(fRayAngle));
+                eyeY.push_back(cosf(fRayAngle));
+            }
+        }
+
+        string sParam = to_string(c.nSize) + "x" + to_string(c.nSize);
+        const char* sEngines[] = { "consolefps/CastRayMarch", "consolefps/CastRayDDA", "consolefps/CastRaySkip" };
+        for (int nEngine = 0; nEngine < 3; nEngine++) {
+            runner.Run(sEngines[nEngine], sParam, [&](long long nOps) {
+                uint64_t nSum = 0;
+                size_t i = 0;
+                for (long long k = 0; k < nOps; k++) {
+                    RayHit hit = nEngine == 0 ? CastRayMarch(map, fPosX, fPosY, eyeX[i], eyeY[i], fDepth)
+                               : nEngine == 1 ? CastRayDDA(map, fPosX, fPosY, eyeX[i], eyeY[i], fDepth)
+                                              : CastRaySkip(map, fPosX, fPosY, eyeX[i], eyeY[i], fDepth);
+                    nSum += hit.nSteps;
+                    if (++i == eyeX.size())
+                        i = 0;
+                }
+                Consume(nSum);
+            });
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------
+// rotatingcube: rotação dos vértices e traçado de linhas
+
+// rotate() do rotatingcube.cpp, que o transform por matriz substituiu no
+// loop principal: um ponto por chamada, com os senos e cossenos recalculados
+// a cada ponto.
+void OldRotate(vec3& point, float x, float y, float z) {
+    float rad = 0;
+    float px, py, pz;
+
+    // Rotação em torno do eixo X
+    rad = x;
+    py = point.y; pz = point.z;
+    point.y = cos(rad) * py - sin(rad) * pz;
+    point.z = sin(rad) * py + cos(rad) * pz;
+
+    // Rotação em torno do eixo Y
+    rad = y;
+    px = point.x; pz = point.z;
+    point.x = cos(rad) * px - sin(rad) * pz;
+    point.z = sin(rad) * px + cos(rad) * pz;
+
+    // Rotação em torno do eixo Z
+    rad = z;
+    px = point.x; py = point.y;
+    point.x = cos(rad) * px - sin(rad) * py;
+    point.y = sin(rad) * px + cos(rad) * py;
+}
+
+void BenchRotatingCube(BenchRunner& runner) {
+    for (int nVertices : { 8, 1000, 100000 }) {
+        BenchRandom rng(3);
+        vertexArray rest, out;
+        for (int i = 0; i < nVertices; i++)
+            rest.push_back({ rng.Unit() * 200 - 100, rng.Unit() * 200 - 100, rng.Unit() * 200 - 100 });
+        vec3 center{ 320, 240, 0 };
+        out.resize(rest.size());
+        string sParam = to_string(nVertices) + " vértices";
+
+        // Uma operação: a malha inteira girada e levada ao centro, com os
+        // mesmos ângulos por frame nos três casos
+        runner.Run("rotatingcube/rotate", sParam, [&](long long nOps) {
+            for (long long k = 0; k < nOps; k++) {
+                for (int i = 0; i < nVertices; i++) {
+                    vec3 point{ rest.x[i], rest.y[i], rest.z[i] };
+                    OldRotate(point, 0.002f * k, 0.001f * k, 0.004f * k);
+                    out.x[i] = point.x + center.x;
+                    out.y[i] = point.y + center.y;
+                    out.z[i] = point.z + center.z;
+                }
+            }
+            Consume((uint64_t)out.x[0]);
+        });
+        runner.Run("rotatingcube/transformScalar", sParam, [&](long long nOps) {
+            for (long long k = 0; k < nOps; k++)
+                transformScalar(mat3::rotation(0.002f * k, 0.001f * k, 0.004f * k), rest, center, out);
+            Consume((uint64_t)out.x[0]);
+        });
+        runner.Run("rotatingcube/transform", sParam, [&](long long nOps) {
+            for (long long k = 0; k < nOps; k++)
+                transform(mat3::rotation(0.002f * k, 0.001f * k, 0.004f * k), rest, center, out);
+            Consume((uint64_t)out.x[0]);
+        });
+    }
+
+    // Linhas de comprimento fixo em direções variadas; a de 2000 pixels
+    // começa e termina fora da tela e exercita o recorte
+    for (int nLength : { 10, 100, 2000 }) {
+        Framebuffer fb(640, 480);
+        BenchRandom rng(5);
+        vector<float> ends;
+        for (int i = 0; i < 1024; i++) {
+            float fAngle = rng.Unit() * 6.2832f;
+            float cx = 320 + (rng.Unit() - 0.5f) * 200, cy = 240 + (rng.Unit() - 0.5f) * 200;
+            float hx = cosf(fAngle) * nLength / 2, hy = sinf(fAngle) * nLength / 2;
+            ends.insert(ends.end(), { cx - hx, cy - hy, cx + hx, cy + hy });
+        }
+        runner.Run("rotatingcube/line", to_string(nLength) + " px", [&](long long nOps) {
+            size_t i = 0;
+            for (long long k = 0; k < nOps; k++) {
+                fb.line(ends[i], ends[i + 1], ends[i + 2], ends[i + 3], 0xFFFFFFFFu);
+                i = i + 4 == ends.size() ? 0 : i + 4;
+            }
+            Consume(fb.pixels[240 * 640 + 320]);
+        });
+    }
+}
+
+// ---------------------------------------------------------------------------
+// flappybird: a atualização de um frame (um passo da simulação)
+
+void BenchFlappyBird(BenchRunner& runner) {
+    struct Size { int nWidth, nHeight; };
+    for (Size s : { Size{ 80, 48 }, Size{ 320, 192 } }) {
+        FlappySim sim(s.nWidth, s.nHeight);
+        FlappyState state;
+        sim.Start(state, 1);
+        runner.Run("flappybird/Step", to_string(s.nWidth) + "x" + to_string(s.nHeight), [&](long long nOps) {
+            for (long long k = 0; k < nOps; k++) {
+                // Bate asa abaixo do meio da tela: partidas longas, com canos
+                if (sim.Step(state, state.fBirdPosition > s.nHeight / 2.0f))
+                    sim.Reset(state);
+            }
+            Consume((uint64_t)state.nFlapCount);
+        });
+    }
+}
+
+// ---------------------------------------------------------------------------
+// snake: busca no corpo, tick com colisão com o corpo e sorteio da comida
+
+// Como o snake.cpp fazia antes do grid de ocupação: o corpo numa deque de
+// vetores float e uma busca linear comparando as duas coordenadas.
+struct OldVec2 { float x, y; };
+
+bool ElementInDeque(OldVec2 element, const deque<OldVec2>& dq) {
+    for (const auto& item : dq) {
+        if (item.x == element.x && item.y == element.y)
+            return true;
+    }
+    return false;
+}
+
+// CheckCollisionWithTail antigo: compara a cabeça com cada segmento depois
+// dela (aqui a cabeça vem de fora, para o laço não virar constante)
+bool OldCollisionWithTail(OldVec2 head, const deque<OldVec2>& body) {
+    for (auto it = body.begin() + 1; it != body.end(); ++it)
+        if (it->x == head.x && it->y == head.y)
+            return true;
+    return false;
+}
+
+// GenerateRandomPos antigo: sorteia qualquer célula e tenta de novo enquanto
+// cair no corpo (o custo cresce com o corpo e com a chance de acertá-lo)
+OldVec2 OldRandomPos(const deque<OldVec2>& body, int nCells, BenchRandom& rng) {
+    OldVec2 pos;
+    do {
+        pos = { (float)(rng.Next() % (uint32_t)nCells), (float)(rng.Next() % (uint32_t)nCells) };
+    } while (ElementInDeque(pos, body));
+    return pos;
+}
+
+// Ciclo que passa uma vez por cada célula de um grid de lado par: a linha
+// 0 da esquerda para a direita, as linhas seguintes em zigue-zague sem a
+// coluna 0, e a volta subindo pela coluna 0. A cobra anda por ele para
+// sempre sem bater em si mesma.
+vector<int> SnakeCycle(const Board& grid) {
+    int n = grid.Width();
+    vector<int> cycle;
+    for (int x = 0; x < n; x++)
+        cycle.push_back(grid.Index(x, 0));
+    for (int y = 1; y < n; y++)
+        for (int i = 0; i < n - 1; i++)
+            cycle.push_back(grid.Index(y % 2 == 1 ? n - 1 - i : 1 + i, y));
+    for (int y = n - 1; y >= 1; y--)
+        cycle.push_back(grid.Index(0, y));
+    return cycle;
+}
+
+// Corpo ocupando as primeiras nLength células do ciclo, com a cabeça em
+// cycle[nLength - 1]. Sem comida, para a cobra não crescer.
+void FillSnake(SnakeSim& sim, const vector<int>& cycle, int nLength) {
+    sim.grid.Clear();
+    sim.body.clear();
+    for (int i = 0; i < nLength; i++) {
+        sim.body.push_front(cycle[i]);
+        sim.grid.Occupy(cycle[i]);
+    }
+    sim.food = -1;
+}
+
+void BenchSnake(BenchRunner& runner) {
+    struct Case { int nCells; int nLength; };
+    for (Case c : { Case{ 24, 3 }, Case{ 24, 288 }, Case{ 24, 570 }, Case{ 100, 5000 }, Case{ 1000, 500000 } }) {
+        SnakeSim sim(c.nCells, 1);
+        vector<int> cycle = SnakeCycle(sim.grid);
+        FillSnake(sim, cycle, c.nLength);
+        string sParam = to_string(c.nCells) + "x" + to_string(c.nCells) + " corpo " + to_string(c.nLength);
+
+        // Consultas a células sorteadas (metade cai no corpo em média)
+        BenchRandom rng(9);
+        vector<int> queries(4096);
+        for (int& q : queries)
+            q = (int)(rng.Next() % (uint32_t)sim.grid.Cells());
+
+        // Referências antigas: só até 10 mil segmentos (as buscas são lineares)
+        deque<OldVec2> body;
+        if (c.nLength <= 10000) {
+            for (int i = 0; i < sim.body.size(); i++)
+                body.push_back({ (float)sim.grid.X(sim.body[i]), (float)sim.grid.Y(sim.body[i]) });
+            runner.Run("snake/ElementInDeque", sParam, [&](long long nOps) {
+                uint64_t nHits = 0;
+                for (long long k = 0; k < nOps; k++) {
+                    int q = queries[k & 4095];
+                    nHits += ElementInDeque({ (float)sim.grid.X(q), (float)sim.grid.Y(q) }, body);
+                }
+                Consume(nHits);
+            });
+            runner.Run("snake/CheckCollisionWithTail (deque)", sParam, [&](long long nOps) {
+                uint64_t nHits = 0;
+                for (long long k = 0; k < nOps; k++) {
+                    int q = queries[k & 4095];
+                    nHits += OldCollisionWithTail({ (float)sim.grid.X(q), (float)sim.grid.Y(q) }, body);
+                }
+                Consume(nHits);
+            });
+        }
+        runner.Run("snake/Board::Occupied", sParam, [&](long long nOps) {
+            uint64_t nHits = 0;
+            for (long long k = 0; k < nOps; k++)
+                nHits += sim.grid.Occupied(queries[k & 4095]);
+            Consume(nHits);
+        });
+        // O que substituiu a busca no corpo: um tick inteiro, em que Move
+        // libera a cauda, consulta o bit da nova cabeça e ocupa a célula
+        // (CheckCollisionWithTail só lê o resultado). A cobra segue o ciclo.
+        size_t nHead = (size_t)c.nLength - 1;
+        runner.Run("snake/Update", sParam, [&](long long nOps) {
+            uint64_t nDeaths = 0;
+            for (long long k = 0; k < nOps; k++) {
+                size_t nNext = nHead + 1 == cycle.size() ? 0 : nHead + 1;
+                int nFrom = cycle[nHead], nTo = cycle[nNext];
+                sim.Turn(sim.grid.X(nTo) - sim.grid.X(nFrom), sim.grid.Y(nTo) - sim.grid.Y(nFrom));
+                nDeaths += sim.Update();
+                nHead = nNext;
+            }
+            Consume(nDeaths);
+        });
+        if (sim.Head() != cycle[nHead])
+            fprintf(stderr, "snake/Update %s: a cobra saiu do ciclo\n", sParam.c_str());
+        runner.Run("snake/GenerateRandomPos", sParam, [&](long long nOps) {
+            uint64_t nSum = 0;
+            for (long long k = 0; k < nOps; k++)
+                nSum += (uint64_t)sim.GenerateRandomPos();
+            Consume(nSum);
+        });
+        if (!body.empty()) {
+            runner.Run("snake/GenerateRandomPos (rejeição)", sParam, [&](long long nOps) {
+                uint64_t nSum = 0;
+                for (long long k = 0; k < nOps; k++)
+                    nSum += (uint64_t)OldRandomPos(body, c.nCells, rng).x;
+                Consume(nSum);
+            });
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------
+
+void PrintResults(FILE* f, const vector<BenchResult>& results, const string& sFormat) {
+    if (sFormat == "csv") {
+        fprintf(f, "benchmark,param,ops,ns_per_op,allocs_per_op,bytes_per_op\n");
+        for (const BenchResult& r : results)
+            fprintf(f, "%s,%s,%lld,%.3f,%.4f,%.1f\n", r.sName.c_str(), r.sParam.c_str(), r.nOps,
+                    r.fNsPerOp, r.fAllocsPerOp, r.fBytesPerOp);
+    }
+    else if (sFormat == "json") {
+        fprintf(f, "{\"benchmarks\": [\n");
+        for (size_t i = 0; i < results.size(); i++) {
+            const BenchResult& r = results[i];
+            fprintf(f, "  {\"benchmark\": \"%s\", \"param\": \"%s\", \"ops\": %lld, \"ns_per_op\": %.3f, "
+                       "\"allocs_per_op\": %.4f, \"bytes_per_op\": %.1f}%s\n",
+                    r.sName.c_str(), r.sParam.c_str(), r.nOps, r.fNsPerOp, r.fAllocsPerOp, r.fBytesPerOp,
+                    i + 1 < results.size() ? "," : "");
+        }
+        fprintf(f, "]}\n");
+    }
+    else {
+        fprintf(f, "%-40s %-28s %14s %12s %12s\n", "benchmark", "parâmetro", "ns/op", "alocs/op", "bytes/op");
+        for (const BenchResult& r : results)
+            fprintf(f, "%-40s %-28s %14.2f %12.4f %12.1f\n", r.sName.c_str(), r.sParam.c_str(),
+                    r.fNsPerOp, r.fAllocsPerOp, r.fBytesPerOp);
+    }
+}
+
+int main(int argc, char* argv[]) {
+    BenchRunner runner;
+    string sFormat = "table";
+    string sOut;
+    for (int i = 1; i < argc; i++) {
+        string sArg = argv[i];
+        if (sArg == "--filter" && i + 1 < argc)
+            runner.sFilter = argv[++i];
+        else if (sArg == "--min-time" && i + 1 < argc)
+            runner.fMinSeconds = atof(argv[++i]) / 1000.0;
+        else if (sArg == "--format" && i + 1 < argc)
+            sFormat = argv[++i];
+        else if (sArg == "--out" && i + 1 < argc)
+            sOut = argv[++i];
+        else {
+            fprintf(stderr, "uso: %s [--filter TEXTO] [--min-time MS] [--format table|csv|json] [--out ARQUIVO]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    BenchConsoleFps(runner);
+    BenchRotatingCube(runner);
+    BenchFlappyBird(runner);
+    BenchSnake(runner);
+
+    FILE* f = stdout;
+    if (!sOut.empty()) {
+        f = fopen(sOut.c_str(), "w");
+        if (!f) {
+            fprintf(stderr, "não foi possível abrir %s\n", sOut.c_str());
+            return 1;
+        }
+    }
+    PrintResults(f, runner.results, sFormat);
+    if (f != stdout)
+        fclose(f);
+    return 0;
+}
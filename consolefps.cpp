@@ -1,9 +1,21 @@
 #include <cmath>       // Biblioteca para funções matemáticas como sin, cos, etc.
 #include <iostream>    // Biblioteca padrão para entrada/saída de dados (como cout).
 #include <chrono>      // Biblioteca para manipulação de tempo e medir duração.
+#include <cstdio>      // Biblioteca para printf (relatórios do benchmark).
+#include <cstdlib>     // Biblioteca para atoi (opções da linha de comando).
+#include <cstring>     // Biblioteca para memcmp (comparação de frames).
+#include <new>         // Biblioteca para alocação alinhada (align_val_t).
+#include <random>      // Biblioteca para gerar mapas de teste reproduzíveis.
 using namespace std;
 
-#include <Windows.h>   // Biblioteca específica do Windows para manipular o console.
+#include "consolefps_map.h"     // Mapa em bits com níveis de blocos vazios.
+#include "consolefps_raycast.h" // Lançamento de raios (passo fixo, DDA e saltos).
+#include "workers.h"            // Threads que desenham as colunas em paralelo.
+#include "consolefps_camera.h"  // Tabelas da câmera (raios por coluna e fundo por linha).
+#include "consolefps_packet.h"  // Lançamento de raios em pacotes SIMD.
+#include "consolefps_console.h" // Console do Windows ou terminal ANSI (Linux).
+#include "consolefps_replay.h"  // Roteiro de teclas, hash de frames e percentis.
+#include "consolefps_profile.h" // Tempo por etapa do frame (-DCONSOLEFPS_PROFILE).
 
 int nScreenWidth = 120;  // Largura da tela do console em caracteres.
 int nScreenHeight = 40;  // Altura da tela do console em caracteres.
@@ -18,15 +30,460 @@ int nMapWidth = 16;      // Largura do mapa em "blocos".
 float fFOV = 3.14159 / 4.0;  // Campo de visão (FOV) do jogador (em radianos).
 float fDepth = 16.0f;        // Profundidade máxima que o jogador pode ver (distância).
 
-int main () {
-    
-    // Cria uma tela de buffer onde o conteúdo será desenhado (com base em largura e altura da tela).
-    wchar_t *screen = new wchar_t[nScreenWidth*nScreenHeight];
-    // Cria um buffer de tela do console para poder imprimir os caracteres.
-    HANDLE hConsole = CreateConsoleScreenBuffer(GENERIC_READ | GENERIC_WRITE, 0, NULL, CONSOLE_TEXTMODE_BUFFER, NULL);
-    SetConsoleActiveScreenBuffer(hConsole);  // Define o buffer como a tela ativa.
-    DWORD dwBytesWritten = 0;  // Variável para armazenar bytes escritos.
+// Quantidade de colunas da tela que ocupa uma linha de cache (tamanho das
+// faixas de colunas divididas entre as threads). As linhas do buffer de
+// desenho têm camera.nRowStride células, um múltiplo desta quantidade, então
+// as fronteiras das faixas caem em fronteiras de linha de cache em todas as
+// linhas e threads diferentes nunca escrevem na mesma linha de cache.
+const int nColumnsPerCacheLine = nCacheLineSize / (int)sizeof(wchar_t);
+
+// Tabelas da câmera, refeitas só quando nScreenWidth, nScreenHeight ou fFOV mudam.
+CameraTables camera;
+
+// Gera um mapa quadrado com borda de paredes e pilares espalhados aleatoriamente.
+// A célula central fica sempre livre para posicionar o jogador.
+wstring GenerateBenchmarkMap(int nSize, float fDensity, unsigned int nSeed) {
+    mt19937 rng(nSeed);
+    uniform_real_distribution<float> dist(0.0f, 1.0f);
+    wstring map((size_t)nSize * nSize, L'.');
+    for (int y = 0; y < nSize; y++) {
+        for (int x = 0; x < nSize; x++) {
+            bool bBorder = x == 0 || y == 0 || x == nSize - 1 || y == nSize - 1;
+            if (bBorder || dist(rng) < fDensity)
+                map[(size_t)y * nSize + x] = '#';
+        }
+    }
+    map[(size_t)(nSize / 2) * nSize + nSize / 2] = '.';
+    return map;
+}
+
+// Aloca um buffer de nWidth x nHeight células alinhado à linha de cache. As
+// threads desenham num buffer com camera.nRowStride células por linha; a tela
+// que vai para o console e para o HashFrame tem nScreenWidth células por
+// linha. Começa zerado, então as células de preenchimento no fim das linhas
+// do buffer de desenho são sempre iguais.
+wchar_t* AllocateScreen(int nWidth, int nHeight) {
+    return new (align_val_t(nCacheLineSize)) wchar_t[nWidth * nHeight]();
+}
+
+void FreeScreen(wchar_t* screen) {
+    operator delete[](screen, align_val_t(nCacheLineSize));
+}
+
+// Desenha as colunas [x0, x1) da tela num buffer com camera.nRowStride
+// células por linha: lança um raio por coluna e preenche o teto, a parede e
+// o chão. Colunas diferentes não compartilham estado, então
+// faixas diferentes podem ser desenhadas por threads diferentes.
+void RenderColumns(wchar_t* screen, const GameMap& map, const CameraView& view, int x0, int x1) {
+    const int nStride = camera.nRowStride;
+    ProfileSpan castSpan, shadeSpan;
+    for(int x = x0; x < x1; x++) {
+        castSpan.Begin();
+        // Direção do "raio": a direção da visão girada pelo ângulo da coluna.
+        float fEyeX, fEyeY;
+        view.Ray(camera, x, fEyeX, fEyeY);
+        
+        // Percorre o mapa até atingir uma parede ou o final do mapa (saltando
+        // blocos vazios se o mapa for aberto).
+        RayHit hit = CastRay(map, fPlayerX, fPlayerY, fEyeX, fEyeY, fDepth);
+        float fDistanceToWall = hit.fDistance;  // Distância até a parede.
+        castSpan.End();
+        shadeSpan.Begin();
+
+        // Linhas do teto e do chão e a "sombra" da parede de acordo com a distância.
+        int nCeiling = CeilingRow(fDistanceToWall, nScreenHeight);
+        int nFloor = nScreenHeight - nCeiling;
+        wchar_t nShade = WallShade(fDistanceToWall, fDepth);
+        
+        // Desenha o teto, a parede e o chão; o teto e o chão vêm da tabela de fundo.
+        wchar_t* column = screen + x;
+        int y = 0;
+        for (; y < nCeiling; y++)
+            column[y * nStride] = camera.background[y];
+        for (; y <= nFloor && y < nScreenHeight; y++)
+            column[y * nStride] = nShade;
+        for (; y < nScreenHeight; y++)
+            column[y * nStride] = camera.background[y];
+        shadeSpan.End();
+    }
+    castSpan.Emit("raios");
+    shadeSpan.Emit("sombra");
+}
+
+// Aplica as teclas de um frame ao jogador: A/D giram, W/S andam e o
+// movimento é desfeito se o jogador entrar numa parede.
+void MovePlayer(const GameMap& map, const PlayerInput& input, float fElapsedTime) {
+    if (input.bLeft)
+        fPlayerA -= (0.8f) * fElapsedTime;
+    if (input.bRight)
+        fPlayerA += (0.8f) * fElapsedTime;
+
+    if (input.bForward) {
+        fPlayerX += sinf(fPlayerA) * 5.0f * fElapsedTime;  // Movimento no eixo X
+        fPlayerY += cosf(fPlayerA) * 5.0f * fElapsedTime;  // Movimento no eixo Y
+        if (map.IsWall((int)fPlayerX, (int)fPlayerY)) {
+            fPlayerX -= sinf(fPlayerA) * 5.0f * fElapsedTime;
+            fPlayerY -= cosf(fPlayerA) * 5.0f * fElapsedTime;
+        }
+    }
+
+    if (input.bBack) {
+        fPlayerX -= sinf(fPlayerA) * 5.0f * fElapsedTime;
+        fPlayerY -= cosf(fPlayerA) * 5.0f * fElapsedTime;
+        if (map.IsWall((int)fPlayerX, (int)fPlayerY)) {
+            fPlayerX += sinf(fPlayerA) * 5.0f * fElapsedTime;
+            fPlayerY += cosf(fPlayerA) * 5.0f * fElapsedTime;
+        }
+    }
+}
+
+// Copia as linhas do buffer de desenho (camera.nRowStride células por linha)
+// para a tela (nScreenWidth células por linha).
+void CopyRows(const wchar_t* frame, wchar_t* screen) {
+    for (int y = 0; y < nScreenHeight; y++)
+        memcpy(screen + (size_t)y * nScreenWidth, frame + (size_t)y * camera.nRowStride, nScreenWidth * sizeof(wchar_t));
+}
+
+// Desenha um frame inteiro: atualiza a câmera e divide as colunas entre as
+// threads, em pacotes SIMD ou coluna a coluna (packets nulo). As threads
+// desenham em frame (camera.nRowStride x nScreenHeight células), que depois é
+// copiado para screen; se a largura já ocupa linhas de cache inteiras, elas
+// desenham direto em screen.
+void RenderFrame(wchar_t* frame, wchar_t* screen, const GameMap& map, WorkerPool& workers,
+                 const PacketRenderer* packets) {
+    camera.Update(nScreenWidth, nScreenHeight, fFOV);
+    CameraView view(fPlayerA);
+    wchar_t* target = camera.nRowStride == nScreenWidth ? screen : frame;
+    workers.Run(nScreenWidth, nColumnsPerCacheLine, [&](int x0, int x1) {
+        if (packets)
+            packets->Render(camera, view, map, target, fPlayerX, fPlayerY, fDepth, x0, x1);
+        else
+            RenderColumns(target, map, view, x0, x1);
+    });
+    if (target != screen)
+        CopyRows(frame, screen);
+    screen[nScreenWidth * nScreenHeight - 1] = '\0';
+}
+
+// Compara o lançamento de raios em passo fixo, o DDA, o DDA com saltos sobre
+// blocos vazios e o motor que o jogo escolhe para o mapa (auto), sem abrir o
+// console. Para cada mapa lança os raios de todas as
+// colunas da tela em vários ângulos e mede o tempo por raio, as consultas ao
+// mapa por raio e quantos raios atingiram células diferentes das do DDA (cantos
+// finos que o passo fixo atravessa). Mostra também a memória do mapa em texto
+// e em bits.
+void RunRaycastBenchmark(const GameMap& gameMap) {
+    struct BenchMap { const char* sName; GameMap map; float fDepth; };
+    auto generate = [](int nSize, float fDensity, unsigned int nSeed) {
+        GameMap map;
+        map.Assign(GenerateBenchmarkMap(nSize, fDensity, nSeed), nSize, nSize);
+        return map;
+    };
+    BenchMap maps[] = {
+        { "jogo",         gameMap,                           fDepth },
+        { "256x256",      generate(256, 0.01f, 1),           256.0f },
+        { "1024x1024",    generate(1024, 0.002f, 2),         1024.0f },
+        { "4096x4096",    generate(4096, 0.0005f, 3),        4096.0f },
+        { "4096 aberto",  generate(4096, 0.0f, 4),           4096.0f },
+    };
+    const int nAngles = 32;  // Quantidade de direções do jogador testadas por mapa.
+    const char* sEngines[] = { "passo", "dda", "salto", "auto" };
+
+    printf("%-12s %8s %12s %10s %-6s %10s %16s %12s\n",
+           "mapa", "prof.", "texto (KB)", "bits (KB)", "motor", "ns/raio", "consultas/raio", "divergentes");
+    for (auto& bm : maps) {
+        float fPosX = bm.map.nWidth / 2 + 0.5f;
+        float fPosY = bm.map.nHeight / 2 + 0.5f;
+        double fTextKB = (double)bm.map.nWidth * bm.map.nHeight * sizeof(wchar_t) / 1024.0;
+        double fBitsKB = (double)bm.map.MemoryBytes() / 1024.0;
+
+        auto cast = [&](int nEngine, float fEyeX, float fEyeY) {
+            if (nEngine == 0)
+                return CastRayMarch(bm.map, fPosX, fPosY, fEyeX, fEyeY, bm.fDepth);
+            if (nEngine == 1)
+                return CastRayDDA(bm.map, fPosX, fPosY, fEyeX, fEyeY, bm.fDepth);
+            if (nEngine == 2)
+                return CastRaySkip(bm.map, fPosX, fPosY, fEyeX, fEyeY, bm.fDepth);
+            return CastRay(bm.map, fPosX, fPosY, fEyeX, fEyeY, bm.fDepth);
+        };
+
+        // Percorre os raios de todas as colunas em todos os ângulos.
+        auto forEachRay = [&](const function<void(float, float)>& fn) {
+            for (int a = 0; a < nAngles; a++) {
+                float fAngle = a * 6.2831853f / nAngles;
+                for (int x = 0; x < nScreenWidth; x++) {
+                    float fRayAngle = (fAngle - fFOV / 2.0f) + ((float)x / (float)nScreenWidth) * fFOV;
+                    fn(sinf(fRayAngle), cosf(fRayAngle));
+                }
+            }
+        };
+
+        // Lança todos os raios com um dos motores e acumula tempo e consultas;
+        // depois conta os raios que atingiram uma célula diferente da do DDA.
+        auto run = [&](int nEngine, long long& nSteps, long long& nMismatch) {
+            auto tp1 = chrono::steady_clock::now();
+            forEachRay([&](float fEyeX, float fEyeY) { nSteps += cast(nEngine, fEyeX, fEyeY).nSteps; });
+            auto tp2 = chrono::steady_clock::now();
+            forEachRay([&](float fEyeX, float fEyeY) {
+                RayHit hit = cast(nEngine, fEyeX, fEyeY);
+                RayHit dda = CastRayDDA(bm.map, fPosX, fPosY, fEyeX, fEyeY, bm.fDepth);
+                if (hit.nCellX != dda.nCellX || hit.nCellY != dda.nCellY)
+                    nMismatch++;
+            });
+            return chrono::duration<double, nano>(tp2 - tp1).count();
+        };
+
+        long long nRays = (long long)nAngles * nScreenWidth;
+        for (int nEngine = 0; nEngine < 4; nEngine++) {
+            long long nSteps = 0, nMismatch = 0;
+            double fNs = run(nEngine, nSteps, nMismatch);
+            printf("%-12s %8.0f %12.1f %10.1f %-6s %10.1f %16.1f %12lld\n",
+                   bm.sName, bm.fDepth, fTextKB, fBitsKB, sEngines[nEngine],
+                   fNs / nRays, (double)nSteps / nRays, nMismatch);
+        }
+    }
+}
+
+// Mede o tempo de frame de uma tela larga (1920x540) com 1, 2, 4, ... threads,
+// até o número de núcleos da máquina, e mostra o ganho em relação a uma thread.
+void RunThreadBenchmark(const GameMap& map) {
+    nScreenWidth = 1920;
+    nScreenHeight = 540;
+    camera.Update(nScreenWidth, nScreenHeight, fFOV);
+    wchar_t *screen = AllocateScreen(camera.nRowStride, nScreenHeight);
+    const int nFrames = 60;
+
+    int nMaxThreads = (int)thread::hardware_concurrency();
+    if (nMaxThreads < 1)
+        nMaxThreads = 1;
+
+    printf("tela %dx%d, %d frames\n", nScreenWidth, nScreenHeight, nFrames);
+    printf("%8s %12s %10s\n", "threads", "ms/frame", "ganho");
+    double fBaseMs = 0.0;
+    for (int nThreads = 1; ; nThreads = nThreads * 2 < nMaxThreads ? nThreads * 2 : nMaxThreads) {
+        WorkerPool workers(nThreads);
+        CameraView view(fPlayerA);
+        auto drawColumns = [&](int x0, int x1) { RenderColumns(screen, map, view, x0, x1); };
+
+        auto tp1 = chrono::steady_clock::now();
+        for (int f = 0; f < nFrames; f++) {
+            fPlayerA = f * 6.2831853f / nFrames;
+            view = CameraView(fPlayerA);
+            workers.Run(nScreenWidth, nColumnsPerCacheLine, drawColumns);
+        }
+        auto tp2 = chrono::steady_clock::now();
+
+        double fMs = chrono::duration<double, milli>(tp2 - tp1).count() / nFrames;
+        if (nThreads == 1)
+            fBaseMs = fMs;
+        printf("%8d %12.3f %9.2fx\n", nThreads, fMs, fBaseMs / fMs);
+        if (nThreads == nMaxThreads)
+            break;
+    }
+    FreeScreen(screen);
+}
+
+// Compara o desenho coluna a coluna com o modo de pacotes (4, 8 e 16 raios)
+// em cada conjunto de instruções disponível, numa tela 1920x540 e em uma thread.
+// Cada frame SIMD é comparado com o frame escalar do mesmo tamanho de pacote.
+void RunPacketBenchmark(const GameMap& map) {
+    nScreenWidth = 1920;
+    nScreenHeight = 540;
+    const int nFrames = 30;
+    camera.Update(nScreenWidth, nScreenHeight, fFOV);
+    const int nCells = camera.nRowStride * nScreenHeight;
+    wchar_t *screen = AllocateScreen(camera.nRowStride, nScreenHeight);
+    wchar_t *reference = AllocateScreen(camera.nRowStride, nScreenHeight);
+    PacketIsa isaDetected = DetectPacketIsa();
+
+    // Tempo médio de um frame desenhado por fn.
+    auto timeFrames = [&](const function<void()>& fn) {
+        auto tp1 = chrono::steady_clock::now();
+        for (int f = 0; f < nFrames; f++) {
+            fPlayerA = f * 6.2831853f / nFrames;
+            fn();
+        }
+        auto tp2 = chrono::steady_clock::now();
+        return chrono::duration<double, milli>(tp2 - tp1).count() / nFrames;
+    };
+
+    printf("tela %dx%d, %d frames, cpu: %s\n", nScreenWidth, nScreenHeight, nFrames, PacketIsaName(isaDetected));
+    printf("%-8s %-8s %12s %10s\n", "pacote", "isa", "ms/frame", "idêntico");
+    double fBaseMs = timeFrames([&] { RenderColumns(screen, map, CameraView(fPlayerA), 0, nScreenWidth); });
+    printf("%-8s %-8s %12.3f %10s\n", "coluna", "escalar", fBaseMs, "-");
+
+    int nWidths[] = { 4, 8, 16 };
+    for (int nWidth : nWidths) {
+        for (int i = ISA_SCALAR; i <= isaDetected; i++) {
+            PacketRenderer renderer(nWidth, (PacketIsa)i);
+            if (renderer.Isa() != i)
+                continue;
+            auto render = [&](wchar_t* dst) {
+                renderer.Render(camera, CameraView(fPlayerA), map, dst, fPlayerX, fPlayerY, fDepth, 0, nScreenWidth);
+            };
+            double fMs = timeFrames([&] { render(screen); });
+
+            // Confere alguns ângulos contra o kernel escalar do mesmo tamanho.
+            PacketRenderer scalar(nWidth, ISA_SCALAR);
+            bool bIdentical = true;
+            for (int f = 0; f < 8; f++) {
+                fPlayerA = f * 0.7853981f + 0.1f;
+                render(screen);
+                scalar.Render(camera, CameraView(fPlayerA), map, reference, fPlayerX, fPlayerY, fDepth, 0, nScreenWidth);
+                bIdentical = bIdentical && memcmp(screen, reference, nCells * sizeof(wchar_t)) == 0;
+            }
+            printf("%-8d %-8s %12.3f %10s\n", nWidth, PacketIsaName(renderer.Isa()), fMs, bIdentical ? "sim" : "NÃO");
+        }
+    }
+    FreeScreen(screen);
+    FreeScreen(reference);
+}
+
+// Mede quantos bytes por frame o terminal ANSI recebe numa sessão simulada
+// (o jogador gira, anda até a parede e fica parado), enviando só as células
+// alteradas e redesenhando a tela inteira a cada frame.
+void RunTerminalBenchmark(const GameMap& map) {
+    camera.Update(nScreenWidth, nScreenHeight, fFOV);
+    wchar_t *frame = AllocateScreen(camera.nRowStride, nScreenHeight);
+    wchar_t *screen = AllocateScreen(nScreenWidth, nScreenHeight);
+    AnsiFrameEncoder diff, full;
+    const int nFrames = 360;
+    const float fElapsedTime = 1.0f / 60.0f;
+    long long nDiffBytes = 0, nFullBytes = 0, nChanged = 0;
+
+    for (int f = 0; f < nFrames; f++) {
+        if (f < 120) {
+            fPlayerA += 0.8f * fElapsedTime;
+        }
+        else if (f < 300) {
+            fPlayerX += sinf(fPlayerA) * 5.0f * fElapsedTime;
+            fPlayerY += cosf(fPlayerA) * 5.0f * fElapsedTime;
+            if (map.IsWall((int)fPlayerX, (int)fPlayerY)) {
+                fPlayerX -= sinf(fPlayerA) * 5.0f * fElapsedTime;
+                fPlayerY -= cosf(fPlayerA) * 5.0f * fElapsedTime;
+            }
+        }
+        RenderColumns(frame, map, CameraView(fPlayerA), 0, nScreenWidth);
+        CopyRows(frame, screen);
+        screen[nScreenWidth * nScreenHeight - 1] = '\0';
+
+        nDiffBytes += diff.Encode(screen, nScreenWidth, nScreenHeight).size();
+        nChanged += diff.ChangedCells();
+        full.Invalidate();
+        nFullBytes += full.Encode(screen, nScreenWidth, nScreenHeight).size();
+    }
+
+    printf("tela %dx%d, %d frames, 1 write() por frame\n", nScreenWidth, nScreenHeight, nFrames);
+    printf("%-28s %12.0f\n", "células alteradas/frame", (double)nChanged / nFrames);
+    printf("%-28s %12.0f\n", "bytes/frame (tela inteira)", (double)nFullBytes / nFrames);
+    printf("%-28s %12.0f\n", "bytes/frame (só alteradas)", (double)nDiffBytes / nFrames);
+    printf("%-28s %11.1fx\n", "redução", (double)nFullBytes / (nDiffBytes ? nDiffBytes : 1));
+    FreeScreen(frame);
+    FreeScreen(screen);
+}
+
+// Opções do modo de repetição sem console.
+struct ReplayOptions {
+    InputTrace trace = InputTrace::Default();  // Teclas de cada frame.
+    float fFrameTime = 1.0f / 60.0f;           // fElapsedTime fixo de cada frame.
+    int nWidth = 0, nHeight = 0;               // Tamanho de tela único (0 usa a lista padrão).
+    string sRecordHashes;                      // Arquivo onde gravar os hashes dos frames.
+    string sCheckHashes;                       // Arquivo com hashes para comparar.
+};
+
+// Repete o roteiro de teclas sem console, com o tempo de frame fixo, em vários
+// tamanhos de tela e mapas. Cada execução começa do mesmo ponto, então os
+// frames são sempre os mesmos: o hash de cada um é combinado num hash da
+// execução e pode ser gravado ou comparado com um arquivo para achar o
+// primeiro frame que mudou. Mostra os percentis do tempo de frame e os raios
+// por segundo. Retorna 1 se os hashes comparados forem diferentes.
+int RunReplayBenchmark(const GameMap& gameMap, const ReplayOptions& options,
+                       WorkerPool& workers, const PacketRenderer* packets) {
+    struct ReplayMap { const char* sName; GameMap map; float fStartX, fStartY; };
+    vector<ReplayMap> maps = { { "jogo", gameMap, fPlayerX, fPlayerY } };
+    struct ScreenSize { int nWidth, nHeight; };
+    vector<ScreenSize> sizes = { { 120, 40 }, { 320, 90 }, { 1920, 540 } };
+    if (options.nWidth > 0 && options.nHeight > 0)
+        sizes = { { options.nWidth, options.nHeight } };
+    bool bHashes = !options.sRecordHashes.empty() || !options.sCheckHashes.empty();
+    if (!bHashes) {
+        maps.push_back({ "1024x1024", GameMap(), 512.5f, 512.5f });
+        maps.back().map.Assign(GenerateBenchmarkMap(1024, 0.002f, 2), 1024, 1024);
+    }
+
+    const float fStartA = fPlayerA;
+    const int nFrames = options.trace.Frames();
+    int nResult = 0;
 
+    printf("%d frames de %.4f s, %d threads, %s\n", nFrames, options.fFrameTime, workers.ThreadCount(),
+           packets ? PacketIsaName(packets->Isa()) : "coluna a coluna");
+    printf("%-10s %-10s %9s %9s %9s %12s %18s\n", "mapa", "tela", "p50 ms", "p95 ms", "p99 ms", "Mraios/s", "hash");
+    for (auto& rm : maps) {
+        for (auto& size : sizes) {
+            nScreenWidth = size.nWidth;
+            nScreenHeight = size.nHeight;
+            wchar_t *frame = AllocateScreen(RowStride(nScreenWidth), nScreenHeight);
+            wchar_t *screen = AllocateScreen(nScreenWidth, nScreenHeight);
+            fPlayerX = rm.fStartX;
+            fPlayerY = rm.fStartY;
+            fPlayerA = fStartA;
+
+            FrameTimes times;
+            vector<uint64_t> hashes(nFrames);
+            uint64_t nRunHash = 14695981039346656037ull;
+            for (int f = 0; f < nFrames; f++) {
+                auto tp1 = chrono::steady_clock::now();
+                {
+                    PROFILE_SCOPE("movimento");
+                    MovePlayer(rm.map, options.trace[f], options.fFrameTime);
+                }
+                RenderFrame(frame, screen, rm.map, workers, packets);
+                auto tp2 = chrono::steady_clock::now();
+                times.ms.push_back(chrono::duration<double, milli>(tp2 - tp1).count());
+                hashes[f] = HashFrame(screen, nScreenWidth * nScreenHeight);
+                nRunHash = (nRunHash ^ hashes[f]) * 1099511628211ull;
+                Profiler::Instance().EndFrame();
+            }
+
+            char sSize[32];
+            snprintf(sSize, sizeof(sSize), "%dx%d", nScreenWidth, nScreenHeight);
+            double fRays = (double)nScreenWidth * nFrames;
+            double fTotal = times.Total();
+            printf("%-10s %-10s %9.3f %9.3f %9.3f %12.2f   %016llx\n", rm.sName, sSize,
+                   times.Percentile(50), times.Percentile(95), times.Percentile(99),
+                   fTotal > 0.0 ? fRays / (fTotal / 1000.0) / 1e6 : 0.0, (unsigned long long)nRunHash);
+            FreeScreen(frame);
+            FreeScreen(screen);
+
+            // Os hashes por frame valem para a primeira execução (o mapa do jogo no primeiro tamanho).
+            if (&size != &sizes[0] || &rm != &maps[0])
+                continue;
+            if (!options.sRecordHashes.empty()) {
+                if (SaveFrameHashes(options.sRecordHashes, hashes))
+                    printf("hashes gravados em %s\n", options.sRecordHashes.c_str());
+                else
+                    fprintf(stderr, "não foi possível gravar %s\n", options.sRecordHashes.c_str());
+            }
+            if (!options.sCheckHashes.empty()) {
+                int nFrame = CompareFrameHashes(options.sCheckHashes, hashes);
+                if (nFrame == -1) {
+                    printf("hashes iguais a %s\n", options.sCheckHashes.c_str());
+                }
+                else {
+                    if (nFrame == -2)
+                        fprintf(stderr, "não foi possível abrir %s\n", options.sCheckHashes.c_str());
+                    else
+                        fprintf(stderr, "frame %d diferente de %s\n", nFrame, options.sCheckHashes.c_str());
+                    nResult = 1;
+                }
+            }
+        }
+    }
+    return nResult;
+}
+
+int main (int argc, char* argv[]) {
+    
     // Criação do mapa com paredes (representadas por '#') e espaços livres ('.').
     wstring map;
     map += L"################";
@@ -45,122 +502,186 @@ int main () {
     map += L"#..............#";
     map += L"#..............#";
     map += L"################";
-    
+
+    // Lê as opções da linha de comando.
+    int nThreads = (int)thread::hardware_concurrency();  // Threads usadas para desenhar.
+    int nPacketWidth = 8;     // Raios por pacote (0 desenha coluna a coluna).
+    PacketIsa isa = ISA_AVX2; // Melhor conjunto de instruções permitido.
+    string sBench;            // Benchmark pedido (vazio abre o jogo).
+    string sMapFile;          // Arquivo de mapa (vazio usa o mapa embutido).
+    ReplayOptions replay;     // Roteiro e hashes do modo --bench-replay.
+    bool bOverlay = false;    // Mostra FPS e ms por etapa na primeira linha.
+    string sTraceFile;        // Arquivo JSON (trace_event do Chrome) gravado ao sair.
+    for (int i = 1; i < argc; i++) {
+        string sArg = argv[i];
+        if (sArg.compare(0, 8, "--bench-") == 0) {
+            sBench = sArg.substr(8);
+        }
+        else if (sArg == "--threads" && i + 1 < argc) {
+            nThreads = atoi(argv[++i]);
+        }
+        else if (sArg == "--packet" && i + 1 < argc) {
+            nPacketWidth = atoi(argv[++i]);
+        }
+        else if (sArg == "--isa" && i + 1 < argc) {
+            string sIsa = argv[++i];
+            isa = sIsa == "escalar" || sIsa == "scalar" ? ISA_SCALAR : sIsa == "sse2" ? ISA_SSE2 : ISA_AVX2;
+        }
+        else if (sArg == "--map" && i + 1 < argc) {
+            sMapFile = argv[++i];
+        }
+        else if (sArg == "--depth" && i + 1 < argc) {
+            fDepth = (float)atof(argv[++i]);
+        }
+        else if (sArg == "--replay" && i + 1 < argc) {
+            string sError;
+            if (!replay.trace.LoadFromFile(argv[++i], sError)) {
+                fprintf(stderr, "%s\n", sError.c_str());
+                return 1;
+            }
+        }
+        else if (sArg == "--frame-time" && i + 1 < argc) {
+            replay.fFrameTime = (float)atof(argv[++i]);
+        }
+        else if (sArg == "--size" && i + 1 < argc) {
+            sscanf(argv[++i], "%dx%d", &replay.nWidth, &replay.nHeight);
+        }
+        else if (sArg == "--record-hashes" && i + 1 < argc) {
+            replay.sRecordHashes = argv[++i];
+        }
+        else if (sArg == "--check-hashes" && i + 1 < argc) {
+            replay.sCheckHashes = argv[++i];
+        }
+        else if (sArg == "--overlay") {
+            bOverlay = true;
+        }
+        else if (sArg == "--trace" && i + 1 < argc) {
+            sTraceFile = argv[++i];
+        }
+    }
+
+    // O perfilador só existe se o jogo for compilado com -DCONSOLEFPS_PROFILE.
+    if ((bOverlay || !sTraceFile.empty()) && !Profiler::Enabled())
+        fprintf(stderr, "perfilador desativado: compile com -DCONSOLEFPS_PROFILE para --overlay e --trace\n");
+    if (!sTraceFile.empty())
+        Profiler::Instance().EnableTrace();
+    // Grava o JSON do perfilador, se pedido.
+    auto exportTrace = [&] {
+        if (!sTraceFile.empty() && Profiler::Instance().ExportChromeTrace(sTraceFile))
+            printf("eventos do perfilador gravados em %s\n", sTraceFile.c_str());
+    };
+
+    // Monta o mapa em bits, a partir do texto embutido ou do arquivo.
+    GameMap gameMap;
+    if (sMapFile.empty()) {
+        gameMap.Assign(map, nMapWidth, nMapHeight);
+    }
+    else {
+        string sError;
+        if (!gameMap.LoadFromFile(sMapFile, sError)) {
+            fprintf(stderr, "%s\n", sError.c_str());
+            return 1;
+        }
+        nMapWidth = gameMap.nWidth;
+        nMapHeight = gameMap.nHeight;
+        fPlayerX = gameMap.nStartX + 0.5f;
+        fPlayerY = gameMap.nStartY + 0.5f;
+    }
+
+    if (sBench == "raycast") {
+        // Compara os motores de raio sem abrir o console.
+        RunRaycastBenchmark(gameMap);
+        return 0;
+    }
+    else if (sBench == "threads") {
+        // Mede o ganho de desenhar as colunas em paralelo.
+        RunThreadBenchmark(gameMap);
+        return 0;
+    }
+    else if (sBench == "packet") {
+        // Mede os kernels de pacote e confere se o resultado é idêntico.
+        RunPacketBenchmark(gameMap);
+        return 0;
+    }
+    else if (sBench == "terminal") {
+        // Mede os bytes enviados ao terminal ANSI por frame.
+        RunTerminalBenchmark(gameMap);
+        return 0;
+    }
+    else if (sBench == "replay") {
+        // Repete o roteiro de teclas sem console com o mesmo renderizador do jogo.
+        WorkerPool workers(nThreads);
+        PacketRenderer packets(nPacketWidth, isa);
+        int nResult = RunReplayBenchmark(gameMap, replay, workers, nPacketWidth > 0 ? &packets : nullptr);
+        exportTrace();
+        return nResult;
+    }
+
+    // Cria uma tela de buffer onde o conteúdo será desenhado (com base em largura e altura da tela)
+    // e o buffer com linhas alinhadas em que as threads desenham.
+    wchar_t *screen = AllocateScreen(nScreenWidth, nScreenHeight);
+    wchar_t *frame = AllocateScreen(RowStride(nScreenWidth), nScreenHeight);
+    // Abre o console (Windows) ou o terminal (ANSI) onde os frames são mostrados.
+    ConsolePresenter presenter;
+    ConsoleKeys keys;
+
+    // Threads persistentes que desenham as faixas de colunas de cada frame.
+    WorkerPool workers(nThreads);
+
+    // Raios em pacotes SIMD, com o conjunto de instruções escolhido pela CPU.
+    PacketRenderer packets(nPacketWidth, isa);
+
     // Inicializa marcadores de tempo para calcular o tempo entre cada frame (para o movimento suave).
     auto tp1 = chrono::system_clock::now();
     auto tp2 = chrono::system_clock::now();    
     
-    // Loop principal do jogo.
-    while(1)
+    // Loop principal do jogo (a tecla 'Q' encerra).
+    while(!keys.Held('Q'))
     {
         // Calcula o tempo passado entre frames.
         tp2 = chrono::system_clock::now();
         chrono::duration<float> elapsedTime = tp2 - tp1;
         tp1 = tp2;
         float fElapsedTime = elapsedTime.count();
-        
-        // Verifica se a tecla 'A' está pressionada e rotaciona o jogador para a esquerda.
-        if (GetAsyncKeyState((unsigned short)'A') & 0x8000) {
-            fPlayerA -= (0.8f) * fElapsedTime;
+
+        // Lê as teclas pressionadas desde o último frame.
+        {
+            PROFILE_SCOPE("entrada");
+            keys.Poll(fElapsedTime);
         }
         
-        // Verifica se a tecla 'D' está pressionada e rotaciona o jogador para a direita.
-        if (GetAsyncKeyState((unsigned short)'D') & 0x8000) {
-            fPlayerA += (0.8f) * fElapsedTime;
+        // A/D giram o jogador e W/S andam, desfazendo o movimento se ele entrar numa parede.
+        PlayerInput input;
+        input.bLeft = keys.Held('A');
+        input.bRight = keys.Held('D');
+        input.bForward = keys.Held('W');
+        input.bBack = keys.Held('S');
+        {
+            PROFILE_SCOPE("movimento");
+            MovePlayer(gameMap, input, fElapsedTime);
         }
         
-        // Verifica se a tecla 'W' está pressionada e move o jogador para frente.
-        if (GetAsyncKeyState((unsigned short)'W') & 0x8000) {
-            fPlayerX += sinf(fPlayerA) * 5.0f * fElapsedTime;  // Movimento no eixo X
-            fPlayerY += cosf(fPlayerA) * 5.0f * fElapsedTime;  // Movimento no eixo Y
-            
-            // Verifica se o jogador colidiu com uma parede. Se sim, desfaz o movimento.
-            if (map[(int)fPlayerY * nMapWidth + (int)fPlayerX] == '#') {
-                fPlayerX -= sinf(fPlayerA) * 5.0f * fElapsedTime;
-                fPlayerY -= cosf(fPlayerA) * 5.0f * fElapsedTime;
-            }
-        }
+        // Renderização de "raios" para determinar a profundidade da parede,
+        // com as faixas de colunas divididas entre as threads.
+        RenderFrame(frame, screen, gameMap, workers, nPacketWidth > 0 ? &packets : nullptr);
         
-        // Verifica se a tecla 'S' está pressionada e move o jogador para trás.
-        if (GetAsyncKeyState((unsigned short)'S') & 0x8000) {
-            fPlayerX -= sinf(fPlayerA) * 5.0f * fElapsedTime;
-            fPlayerY -= cosf(fPlayerA) * 5.0f * fElapsedTime;
-            
-            // Verifica se o jogador colidiu com uma parede. Se sim, desfaz o movimento.
-            if (map[(int)fPlayerY * nMapWidth + (int)fPlayerX] == '#') {
-                fPlayerX += sinf(fPlayerA) * 5.0f * fElapsedTime;
-                fPlayerY += cosf(fPlayerA) * 5.0f * fElapsedTime;
-            }
-        }
-        
-        // Renderização de "raios" para determinar a profundidade da parede.
-        for(int x = 0; x < nScreenWidth; x++) {
-            // Calcula o ângulo do "raio" baseado no campo de visão (FOV).
-            float fRayAngle = (fPlayerA - fFOV / 2.0f) + ((float)x / (float)nScreenWidth) * fFOV;
-            
-            float fDistanceToWall = 0;  // Distância até a parede.
-            bool bHitWall = false;      // Se o "raio" atingiu a parede.
-            
-            float fEyeX = sinf(fRayAngle);  // Direção no eixo X.
-            float fEyeY = cosf(fRayAngle);  // Direção no eixo Y.
-            
-            // Calcula a distância do raio até a parede ou o final do mapa.
-            while(!bHitWall && fDistanceToWall < fDepth) {
-                fDistanceToWall += 0.1f;  // Incrementa a distância
-                
-                int nTestX = (int)(fPlayerX + fEyeX * fDistanceToWall);
-                int nTestY = (int)(fPlayerY + fEyeY * fDistanceToWall);
-                
-                // Se o raio ultrapassar os limites do mapa, assume que atingiu o "infinito".
-                if (nTestX < 0 || nTestX >= nMapWidth || nTestY < 0 || nTestY >= nMapHeight) {
-                    bHitWall = true;
-                    fDistanceToWall = fDepth;  
-                }
-                else {
-                    // Verifica se o raio atingiu uma parede.
-                    if (map[nTestY * nMapWidth + nTestX] == '#') {
-                        bHitWall = true;
-                    }
-                }
-            }
-        }
+        // Escreve FPS e ms por etapa (dos frames anteriores) por cima do frame.
+        if (bOverlay)
+            Profiler::Instance().DrawOverlay(screen, nScreenWidth);
 
-        // Desenha o teto, parede e chão de acordo com a distância calculada (fDistanceToWall).
-        int nCeiling = (float)(nScreenHeight / 2.0) - nScreenHeight / ((float)fDistanceWall);
-        int nFloor = nScreenHeight - nCeiling;
-        
-        short nShade = ' ';  // Variável para representar a "sombra" da parede com base na distância.
-        
-        // Define o tipo de sombra com base na distância até a parede.
-        if (fDistanceToWall <= fDepth / 4.0f)           nShade = 0x2588; // Muito perto
-        else if (fDistanceToWall < fDepth / 3.0f)       nShade = 0x2593;
-        else if (fDistanceToWall < fDepth / 2.0f)       nShade = 0x2592;
-        else if (fDistanceToWall < fDepth)              nShade = 0x2591;
-        else                                            nShade = ' ';
-        
-        // Desenha o teto, parede e chão na tela com base na distância calculada.
-        for (int y = 0; y < nScreenHeight; y++) {
-            if (y < nCeiling) {
-                screen[y * nScreenWidth + x] = ' ';  // Desenha o teto.
-            }
-            else if (y >= nCeiling && y <= nFloor) {
-                screen[y * nScreenWidth + x] = nShade;  // Desenha a parede.
-            }
-            else {
-                // Calcula o sombreamento do chão.
-                float b = 1.0f - (((float)y - nScreenHeight / 2.0f) / ((float)nScreenHeight / 2.0f));
-                if (b < 0.25)           nShade = '#';
-                else if (b < 0.5)       nShade = 'X';
-                else if (b < 0.75)      nShade = '.';
-                else if (b < 0.9)       nShade = '-';
-                else                    nShade = ' ';
-                screen[y * nScreenWidth + x] = ' ';
-            }
-        }
-        
         // Atualiza a tela do console com o buffer de caracteres gerado.
-        screen[nScreenWidth * nScreenHeight - 1] = '\0';
-        WriteConsoleOutputCharacter(hConsole, screen, nScreenWidth * nScreenHeight, {0,0}, &dwBytesWritten);
+        {
+            PROFILE_SCOPE("tela");
+            presenter.Present(screen, nScreenWidth, nScreenHeight);
+        }
+        Profiler::Instance().EndFrame();
     }
+
+    // Devolve o console ao estado original e mostra o custo de apresentação.
+    presenter.Restore();
+    const PresentStats& stats = presenter.Stats();
+    printf("%lld frames: %.0f bytes/frame, %.2f escritas/frame, %.0f células/frame\n",
+           stats.nFrames, stats.BytesPerFrame(), stats.SyscallsPerFrame(), stats.CellsPerFrame());
+    exportTrace();
     return 0;
 }
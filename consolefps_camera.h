@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cmath>       // Biblioteca para sinf e cosf (só na montagem das tabelas).
+#include <vector>
+using namespace std;
+
+#include "workers.h"   // nCacheLineSize (alinhamento das linhas do buffer de desenho).
+
+// Caractere do chão na linha y. Acima do meio da tela o gradiente dá sempre
+// espaço, então a mesma tabela serve de fundo para o teto e para o chão.
+inline wchar_t FloorShade(int y, int nScreenHeight) {
+    float b = 1.0f - (((float)y - nScreenHeight / 2.0f) / ((float)nScreenHeight / 2.0f));
+    if (b < 0.25)           return '#';
+    else if (b < 0.5)       return 'X';
+    else if (b < 0.75)      return '.';
+    else if (b < 0.9)       return '-';
+    return ' ';
+}
+
+// Caractere da parede conforme a distância. Soma as comparações com os
+// limites em vez de encadear ifs, então o laço de colunas não tem desvios.
+inline wchar_t WallShade(float fDistanceToWall, float fDepth) {
+    static const wchar_t shades[5] = { ' ', 0x2591, 0x2592, 0x2593, 0x2588 };
+    int n = (fDistanceToWall < fDepth) + (fDistanceToWall < fDepth / 2.0f) +
+            (fDistanceToWall < fDepth / 3.0f) + (fDistanceToWall <= fDepth / 4.0f);
+    return shades[n];
+}
+
+// Linha do teto para uma parede a essa distância. Valores negativos (parede
+// colada no jogador) são levados a zero, o que não muda o desenho e evita
+// estouro na conversão para inteiro.
+inline int CeilingRow(float fDistanceToWall, int nScreenHeight) {
+    float fCeiling = (float)(nScreenHeight / 2.0) - (float)nScreenHeight / fDistanceToWall;
+    return (int)(fCeiling > 0.0f ? fCeiling : 0.0f);
+}
+
+// Células por linha do buffer em que as threads desenham: a largura
+// arredondada para um número inteiro de linhas de cache, para que toda linha
+// da tela comece numa linha de cache.
+inline int RowStride(int nWidth) {
+    const int nCells = nCacheLineSize / (int)sizeof(wchar_t);
+    return (nWidth + nCells - 1) / nCells * nCells;
+}
+
+// Tabelas da câmera que só dependem do tamanho da tela e do FOV: o seno e o
+// cosseno do ângulo de cada coluna em relação ao centro da visão e o
+// caractere de fundo (teto/chão) de cada linha.
+struct CameraTables {
+    int nScreenWidth = 0;
+    int nScreenHeight = 0;
+    int nRowStride = 0;           // Células por linha no buffer de desenho (RowStride).
+    float fFOV = 0.0f;
+    vector<float> fColumnCos;     // Cosseno do deslocamento de cada coluna.
+    vector<float> fColumnSin;     // Seno do deslocamento de cada coluna.
+    vector<wchar_t> background;   // Caractere do teto/chão de cada linha.
+
+    // Refaz as tabelas só se a tela ou o FOV mudaram. Retorna se refez.
+    bool Update(int nWidth, int nHeight, float fFieldOfView) {
+        if (nWidth == nScreenWidth && nHeight == nScreenHeight && fFieldOfView == fFOV)
+            return false;
+        nScreenWidth = nWidth;
+        nScreenHeight = nHeight;
+        nRowStride = RowStride(nWidth);
+        fFOV = fFieldOfView;
+
+        fColumnCos.resize(nWidth);
+        fColumnSin.resize(nWidth);
+        for (int x = 0; x < nWidth; x++) {
+            float fOffset = -fFieldOfView / 2.0f + ((float)x / (float)nWidth) * fFieldOfView;
+            fColumnCos[x] = cosf(fOffset);
+            fColumnSin[x] = sinf(fOffset);
+        }
+
+        background.resize(nHeight);
+        for (int y = 0; y < nHeight; y++)
+            background[y] = FloorShade(y, nHeight);
+        return true;
+    }
+};
+
+// Direção da visão e vetor do plano da câmera (perpendicular, unitário) de
+// um frame. O raio da coluna x é a direção girada pelo deslocamento da
+// coluna: dir * cos + plano * sen, sem nenhuma trigonometria por coluna.
+struct CameraView {
+    float fDirX, fDirY;      // Direção para onde o jogador olha.
+    float fPlaneX, fPlaneY;  // Plano da câmera.
+
+    explicit CameraView(float fAngle) {
+        fDirX = sinf(fAngle);
+        fDirY = cosf(fAngle);
+        fPlaneX = fDirY;
+        fPlaneY = -fDirX;
+    }
+
+    void Ray(const CameraTables& cam, int x, float& fEyeX, float& fEyeY) const {
+        fEyeX = fDirX * cam.fColumnCos[x] + fPlaneX * cam.fColumnSin[x];
+        fEyeY = fDirY * cam.fColumnCos[x] + fPlaneY * cam.fColumnSin[x];
+    }
+};
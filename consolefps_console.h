@@ -0,0 +1,358 @@
+#pragma once
+
+#include <cstdint>     // Tipos inteiros de tamanho fixo.
+#include <string>
+#include <vector>
+using namespace std;
+
+#ifdef _WIN32
+#include <Windows.h>   // Biblioteca específica do Windows para manipular o console.
+#else
+#include <cerrno>
+#include <termios.h>   // Modo bruto do terminal (sem eco, sem buffer de linha).
+#include <unistd.h>    // read() e write() no terminal.
+#endif
+
+// Contadores da apresentação dos frames no console.
+struct PresentStats {
+    long long nFrames = 0;    // Frames apresentados.
+    long long nBytes = 0;     // Bytes enviados ao console.
+    long long nSyscalls = 0;  // Chamadas de sistema de escrita.
+    long long nCells = 0;     // Células enviadas (alteradas ou reenviadas).
+
+    double BytesPerFrame() const { return nFrames ? (double)nBytes / nFrames : 0.0; }
+    double SyscallsPerFrame() const { return nFrames ? (double)nSyscalls / nFrames : 0.0; }
+    double CellsPerFrame() const { return nFrames ? (double)nCells / nFrames : 0.0; }
+};
+
+// Tabela com a codificação UTF-8 pronta dos caracteres usados pelo jogo:
+// ASCII e o bloco de 0x2500 a 0x25FF (inclui os sombreados 0x2588..0x2593).
+// Outros caracteres são codificados na hora.
+class Utf8GlyphTable {
+public:
+    Utf8GlyphTable() {
+        for (int c = 0; c < 0x80; c++)
+            ascii[c] = Glyph(c);
+        for (int c = 0; c < 0x100; c++)
+            blocks[c] = Glyph(0x2500 + c);
+        ascii[0] = Glyph(' ');  // O terminador '\0' do buffer vira espaço.
+    }
+
+    // Acrescenta a codificação UTF-8 de c em out e retorna a quantidade de bytes.
+    int Append(wchar_t c, string& out) const {
+        unsigned int u = (unsigned int)c;
+        const Utf8 *g;
+        Utf8 tmp;
+        if (u < 0x80)
+            g = &ascii[u];
+        else if (u >= 0x2500 && u < 0x2600)
+            g = &blocks[u - 0x2500];
+        else {
+            tmp = Glyph(u);
+            g = &tmp;
+        }
+        out.append(g->sBytes, g->nLength);
+        return g->nLength;
+    }
+
+    // Quantidade de bytes de c em UTF-8.
+    int Length(wchar_t c) const {
+        unsigned int u = (unsigned int)c;
+        if (u < 0x80) return 1;
+        if (u < 0x800) return 2;
+        if (u < 0x10000) return 3;
+        return 4;
+    }
+
+private:
+    struct Utf8 {
+        char sBytes[4];
+        int nLength;
+    };
+
+    static Utf8 Glyph(unsigned int u) {
+        Utf8 g = {};
+        if (u < 0x80) {
+            g.sBytes[0] = (char)u;
+            g.nLength = 1;
+        }
+        else if (u < 0x800) {
+            g.sBytes[0] = (char)(0xC0 | (u >> 6));
+            g.sBytes[1] = (char)(0x80 | (u & 0x3F));
+            g.nLength = 2;
+        }
+        else if (u < 0x10000) {
+            g.sBytes[0] = (char)(0xE0 | (u >> 12));
+            g.sBytes[1] = (char)(0x80 | ((u >> 6) & 0x3F));
+            g.sBytes[2] = (char)(0x80 | (u & 0x3F));
+            g.nLength = 3;
+        }
+        else {
+            g.sBytes[0] = (char)(0xF0 | (u >> 18));
+            g.sBytes[1] = (char)(0x80 | ((u >> 12) & 0x3F));
+            g.sBytes[2] = (char)(0x80 | ((u >> 6) & 0x3F));
+            g.sBytes[3] = (char)(0x80 | (u & 0x3F));
+            g.nLength = 4;
+        }
+        return g;
+    }
+
+    Utf8 ascii[0x80];
+    Utf8 blocks[0x100];
+};
+
+// Codifica frames como sequências ANSI/VT. Guarda o frame anterior e envia só
+// as células que mudaram: cada trecho alterado de uma linha vira um único
+// movimento de cursor seguido dos caracteres. Trechos próximos são unidos
+// quando reenviar as células iguais do meio custa menos que mover o cursor.
+class AnsiFrameEncoder {
+public:
+    // Gera os bytes que levam o terminal do frame anterior para o atual.
+    const string& Encode(const wchar_t* screen, int nWidth, int nHeight) {
+        out.clear();
+        nChangedCells = 0;
+        nSentCells = 0;
+
+        // Tamanho novo (ou primeiro frame): limpa o terminal e redesenha tudo.
+        if (nWidth != nPrevWidth || nHeight != nPrevHeight) {
+            nPrevWidth = nWidth;
+            nPrevHeight = nHeight;
+            previous.assign(nWidth * nHeight, (wchar_t)0xFFFF);
+            out += "\x1b[2J";
+            nCursorX = nCursorY = -1;
+        }
+
+        for (int y = 0; y < nHeight; y++) {
+            const wchar_t* row = screen + y * nWidth;
+            wchar_t* prevRow = previous.data() + y * nWidth;
+            int x = 0;
+            while (x < nWidth) {
+                if (Same(row[x], prevRow[x])) {
+                    x++;
+                    continue;
+                }
+
+                // Estende o trecho enquanto os intervalos iguais forem baratos.
+                int nLast = x;
+                int nGapBytes = 0;
+                for (int j = x + 1; j < nWidth; j++) {
+                    if (!Same(row[j], prevRow[j])) {
+                        nLast = j;
+                        nGapBytes = 0;
+                    }
+                    else {
+                        nGapBytes += glyphs.Length(Visible(row[j]));
+                        if (nGapBytes > nMoveCost)
+                            break;
+                    }
+                }
+
+                MoveCursor(x, y);
+                for (int j = x; j <= nLast; j++) {
+                    if (!Same(row[j], prevRow[j]))
+                        nChangedCells++;
+                    glyphs.Append(Visible(row[j]), out);
+                    prevRow[j] = row[j];
+                }
+                nSentCells += nLast - x + 1;
+
+                // Depois da última coluna o terminal fica aguardando a quebra
+                // de linha, então a posição do cursor deixa de ser conhecida.
+                nCursorX = nLast + 1 < nWidth ? nLast + 1 : -1;
+                nCursorY = nCursorX < 0 ? -1 : y;
+                x = nLast + 1;
+            }
+        }
+        return out;
+    }
+
+    // Esquece o frame anterior: o próximo Encode redesenha a tela inteira.
+    void Invalidate() {
+        nPrevWidth = nPrevHeight = -1;
+    }
+
+    int ChangedCells() const { return nChangedCells; }
+    int SentCells() const { return nSentCells; }
+
+private:
+    // O '\0' do fim do buffer aparece como espaço.
+    static wchar_t Visible(wchar_t c) { return c == L'\0' ? L' ' : c; }
+    static bool Same(wchar_t a, wchar_t b) { return Visible(a) == Visible(b); }
+
+    // Move o cursor para (x, y): nada se ele já estiver lá, "avançar n
+    // colunas" na mesma linha, ou posição absoluta.
+    void MoveCursor(int x, int y) {
+        if (y == nCursorY && x == nCursorX)
+            return;
+        out += "\x1b[";
+        if (y == nCursorY && x > nCursorX) {
+            AppendInt(x - nCursorX);
+            out += 'C';
+        }
+        else {
+            AppendInt(y + 1);
+            out += ';';
+            AppendInt(x + 1);
+            out += 'H';
+        }
+    }
+
+    void AppendInt(int n) {
+        char buf[12];
+        int i = 0;
+        do { buf[i++] = (char)('0' + n % 10); n /= 10; } while (n > 0);
+        while (i > 0)
+            out += buf[--i];
+    }
+
+    // Custo aproximado, em bytes, de mover o cursor ("\x1b[yy;xxH").
+    static const int nMoveCost = 8;
+
+    Utf8GlyphTable glyphs;
+    vector<wchar_t> previous;
+    string out;
+    int nPrevWidth = -1, nPrevHeight = -1;
+    int nCursorX = -1, nCursorY = -1;
+    int nChangedCells = 0;
+    int nSentCells = 0;
+};
+
+#ifdef _WIN32
+
+// Apresenta os frames em um buffer de console do Windows: uma chamada a
+// WriteConsoleOutputCharacter por frame com a tela inteira.
+class ConsolePresenter {
+public:
+    ConsolePresenter() {
+        hConsole = CreateConsoleScreenBuffer(GENERIC_READ | GENERIC_WRITE, 0, NULL, CONSOLE_TEXTMODE_BUFFER, NULL);
+        SetConsoleActiveScreenBuffer(hConsole);  // Define o buffer como a tela ativa.
+    }
+
+    void Present(const wchar_t* screen, int nWidth, int nHeight) {
+        DWORD dwBytesWritten = 0;  // Variável para armazenar bytes escritos.
+        WriteConsoleOutputCharacter(hConsole, screen, nWidth * nHeight, {0,0}, &dwBytesWritten);
+        stats.nFrames++;
+        stats.nSyscalls++;
+        stats.nBytes += (long long)nWidth * nHeight * sizeof(wchar_t);
+        stats.nCells += (long long)nWidth * nHeight;
+    }
+
+    void Restore() {}
+
+    const PresentStats& Stats() const { return stats; }
+
+private:
+    HANDLE hConsole;
+    PresentStats stats;
+};
+
+// Teclado do Windows: consulta o estado atual de cada tecla.
+class ConsoleKeys {
+public:
+    void Poll(float) {}
+    bool Held(char c) const { return (GetAsyncKeyState((unsigned short)c) & 0x8000) != 0; }
+};
+
+#else
+
+// Apresenta os frames em um terminal ANSI/VT (Linux, SSH). Coloca o terminal
+// em modo bruto na tela alternativa, envia só as células alteradas e manda
+// cada frame com uma única chamada a write().
+class ConsolePresenter {
+public:
+    ConsolePresenter() {
+        if (tcgetattr(STDIN_FILENO, &saved) == 0) {
+            bRawMode = true;
+            termios raw = saved;
+            raw.c_lflag &= ~(ICANON | ECHO | ISIG);  // Ctrl+C chega como tecla e encerra o jogo.
+            raw.c_cc[VMIN] = 0;   // read() não bloqueia: o jogo lê as teclas a cada frame.
+            raw.c_cc[VTIME] = 0;
+            tcsetattr(STDIN_FILENO, TCSANOW, &raw);
+        }
+        // Tela alternativa e cursor escondido.
+        WriteAll("\x1b[?1049h\x1b[?25l", 14);
+    }
+
+    ~ConsolePresenter() {
+        Restore();
+    }
+
+    void Present(const wchar_t* screen, int nWidth, int nHeight) {
+        const string& bytes = encoder.Encode(screen, nWidth, nHeight);
+        stats.nFrames++;
+        stats.nCells += encoder.SentCells();
+        stats.nBytes += bytes.size();
+        stats.nSyscalls += WriteAll(bytes.data(), bytes.size());
+    }
+
+    // Devolve o terminal ao estado original.
+    void Restore() {
+        if (bRestored)
+            return;
+        bRestored = true;
+        WriteAll("\x1b[?25h\x1b[?1049l", 14);
+        if (bRawMode)
+            tcsetattr(STDIN_FILENO, TCSANOW, &saved);
+    }
+
+    const PresentStats& Stats() const { return stats; }
+
+private:
+    // Escreve tudo, repetindo a chamada se o terminal aceitar só uma parte.
+    // Retorna a quantidade de chamadas a write().
+    int WriteAll(const char* data, size_t nSize) {
+        int nCalls = 0;
+        while (nSize > 0) {
+            ssize_t n = write(STDOUT_FILENO, data, nSize);
+            nCalls++;
+            if (n < 0) {
+                if (errno == EINTR || errno == EAGAIN)
+                    continue;
+                break;
+            }
+            data += n;
+            nSize -= n;
+        }
+        return nCalls;
+    }
+
+    AnsiFrameEncoder encoder;
+    PresentStats stats;
+    termios saved;
+    bool bRawMode = false;
+    bool bRestored = false;
+};
+
+// Teclado do terminal: o terminal só informa teclas pressionadas (com
+// repetição automática), então uma tecla conta como segurada por um curto
+// intervalo depois de cada byte recebido.
+class ConsoleKeys {
+public:
+    void Poll(float fElapsedTime) {
+        for (auto& f : fHoldTime)
+            f -= fElapsedTime;
+        char buf[64];
+        ssize_t n;
+        while ((n = read(STDIN_FILENO, buf, sizeof(buf))) > 0) {
+            for (ssize_t i = 0; i < n; i++) {
+                unsigned char c = (unsigned char)buf[i];
+                if (c >= 'a' && c <= 'z')
+                    c = c - 'a' + 'A';
+                else if (c == 3)
+                    c = 'Q';  // Ctrl+C
+                if (c < 128)
+                    fHoldTime[c] = fHoldLength;
+            }
+        }
+    }
+
+    bool Held(char c) const { return fHoldTime[(unsigned char)c & 0x7F] > 0.0f; }
+
+private:
+    // Tempo (em segundos) em que a tecla continua segurada após cada byte,
+    // um pouco maior que o intervalo da repetição automática do terminal.
+    static constexpr float fHoldLength = 0.1f;
+    float fHoldTime[128] = {};
+};
+
+#endif
@@ -0,0 +1,283 @@
+#pragma once
+
+#include <cstdint>     // Tipos inteiros de tamanho fixo (uint32_t).
+#include <cstdio>      // Leitura de arquivos pequenos (fopen/fread).
+#include <string>
+#include <vector>
+using namespace std;
+
+#ifdef _WIN32
+#include <Windows.h>   // CreateFileMapping/MapViewOfFile para arquivos grandes.
+#else
+#include <fcntl.h>     // open()
+#include <sys/mman.h>  // mmap()
+#include <sys/stat.h>  // fstat()
+#include <unistd.h>    // close()
+#endif
+
+// Grid de bits: uma célula por bit, com cada linha começando numa palavra
+// de 32 bits nova. Os kernels SIMD leem as palavras diretamente com gather.
+struct BitGrid {
+    int nWidth = 0;
+    int nHeight = 0;
+    int nWordsPerRow = 0;
+    vector<uint32_t> words;
+
+    void Resize(int w, int h) {
+        nWidth = w;
+        nHeight = h;
+        nWordsPerRow = (w + 31) / 32;
+        words.assign((size_t)nWordsPerRow * h, 0);
+    }
+
+    bool Get(int x, int y) const {
+        return (words[(size_t)y * nWordsPerRow + (x >> 5)] >> (x & 31)) & 1;
+    }
+
+    void Set(int x, int y) {
+        words[(size_t)y * nWordsPerRow + (x >> 5)] |= 1u << (x & 31);
+    }
+
+    size_t MemoryBytes() const { return words.size() * sizeof(uint32_t); }
+};
+
+// Mapa do jogo: grid de paredes em bits e dois níveis grosseiros de ocupação,
+// com um bit por bloco de 8x8 e de 64x64 células (1 = o bloco tem parede).
+// Os raios usam os níveis grosseiros para atravessar áreas vazias de uma vez.
+class GameMap {
+public:
+    static const int nBlockShift = 3;        // Blocos finos: 8x8 células.
+    static const int nLargeBlockShift = 6;   // Blocos grandes: 64x64 células.
+
+    int nWidth = 0;
+    int nHeight = 0;
+    int nStartX = -1;   // Posição inicial do jogador no mapa lido de arquivo (-1 no mapa embutido).
+    int nStartY = -1;
+    BitGrid cells;      // Paredes, uma por bit.
+    BitGrid blocks;     // Blocos de 8x8 que têm alguma parede.
+    BitGrid largeBlocks; // Blocos de 64x64 que têm alguma parede.
+    int nEmptyLargeBlocks = 0; // Blocos de 64x64 sem nenhuma parede.
+
+    // Monta o mapa a partir do texto do jogo ('#' é parede).
+    void Assign(const wstring& map, int w, int h) {
+        Reset(w, h);
+        for (int y = 0; y < h; y++)
+            for (int x = 0; x < w; x++)
+                if (map[y * w + x] == '#')
+                    cells.Set(x, y);
+        BuildBlocks();
+    }
+
+    // Lê um mapa de um arquivo de texto: '#' é parede, '@' marca a posição
+    // inicial do jogador e qualquer outro caractere é espaço livre. Sem '@',
+    // o jogador começa na célula livre mais próxima do centro. A largura é a
+    // da maior linha. Arquivos grandes são mapeados na memória com mmap em vez
+    // de copiados. Retorna false e preenche sError se falhar.
+    bool LoadFromFile(const string& sPath, string& sError) {
+        MappedFile file;
+        if (!file.Open(sPath, sError))
+            return false;
+        Parse(file.Data(), file.Size());
+        if (nWidth == 0 || nHeight == 0) {
+            sError = "mapa vazio: " + sPath;
+            return false;
+        }
+        if (nStartX < 0 && !FindFreeCell(nWidth / 2, nHeight / 2, nStartX, nStartY)) {
+            sError = "mapa sem célula livre para o jogador: " + sPath;
+            return false;
+        }
+        return true;
+    }
+
+    // Parede ou fora do mapa (usado na colisão do jogador).
+    bool IsWall(int x, int y) const {
+        if (x < 0 || x >= nWidth || y < 0 || y >= nHeight)
+            return true;
+        return cells.Get(x, y);
+    }
+
+    bool InBounds(int x, int y) const {
+        return x >= 0 && x < nWidth && y >= 0 && y < nHeight;
+    }
+
+    // Se vale a pena lançar os raios saltando blocos vazios (CastRaySkip) em
+    // vez do DDA. Cada salto custa mais que um passo do DDA e só compensa
+    // quando atravessa um bloco de 64x64 inteiro: com pilares espalhados
+    // (quase todo bloco grande tem parede) o salto é mais lento. Medido em
+    // mapas de 2048x2048, o salto passa a ganhar com cerca de 40% dos blocos
+    // grandes vazios. Com fDepth menor que um bloco grande o raio nunca
+    // atravessa um, e o DDA também ganha.
+    bool UseBlockSkip(float fDepth) const {
+        return fDepth >= (float)(1 << nLargeBlockShift) &&
+               nEmptyLargeBlocks * 5 >= largeBlocks.nWidth * largeBlocks.nHeight * 2;
+    }
+
+    // Memória usada pelo grid e pelos níveis grosseiros.
+    size_t MemoryBytes() const {
+        return cells.MemoryBytes() + blocks.MemoryBytes() + largeBlocks.MemoryBytes();
+    }
+
+private:
+    void Reset(int w, int h) {
+        nWidth = w;
+        nHeight = h;
+        nStartX = nStartY = -1;
+        cells.Resize(w, h);
+    }
+
+    // Procura a célula livre mais próxima de (cx, cy) em anéis quadrados cada
+    // vez maiores. Retorna false se o mapa inteiro for parede.
+    bool FindFreeCell(int cx, int cy, int& x, int& y) const {
+        int nMaxRadius = nWidth > nHeight ? nWidth : nHeight;
+        for (int r = 0; r <= nMaxRadius; r++) {
+            for (int dy = -r; dy <= r; dy++) {
+                // Primeira e última linha do anel inteiras; nas outras, só as pontas.
+                int nStep = dy == -r || dy == r ? 1 : 2 * r;
+                for (int dx = -r; dx <= r; dx += nStep) {
+                    if (!IsWall(cx + dx, cy + dy)) {
+                        x = cx + dx;
+                        y = cy + dy;
+                        return true;
+                    }
+                }
+            }
+        }
+        return false;
+    }
+
+    // Marca os blocos de 8x8 e de 64x64 que têm pelo menos uma parede.
+    void BuildBlocks() {
+        blocks.Resize((nWidth + 7) >> nBlockShift, (nHeight + 7) >> nBlockShift);
+        largeBlocks.Resize((nWidth + 63) >> nLargeBlockShift, (nHeight + 63) >> nLargeBlockShift);
+        for (int y = 0; y < nHeight; y++) {
+            const uint32_t* row = &cells.words[(size_t)y * cells.nWordsPerRow];
+            for (int i = 0; i < cells.nWordsPerRow; i++) {
+                if (!row[i])
+                    continue;
+                // Cada byte da palavra cobre as 8 colunas de um bloco.
+                for (int b = 0; b < 4; b++)
+                    if ((row[i] >> (8 * b)) & 0xFF)
+                        blocks.Set(i * 4 + b, y >> nBlockShift);
+            }
+        }
+        for (int by = 0; by < blocks.nHeight; by++)
+            for (int bx = 0; bx < blocks.nWidth; bx++)
+                if (blocks.Get(bx, by))
+                    largeBlocks.Set(bx >> (nLargeBlockShift - nBlockShift), by >> (nLargeBlockShift - nBlockShift));
+        nEmptyLargeBlocks = 0;
+        for (int by = 0; by < largeBlocks.nHeight; by++)
+            for (int bx = 0; bx < largeBlocks.nWidth; bx++)
+                nEmptyLargeBlocks += !largeBlocks.Get(bx, by);
+    }
+
+    // Duas passadas sobre o texto: a primeira mede o mapa e a segunda marca as paredes.
+    void Parse(const char* data, size_t nSize) {
+        int w = 0, h = 0, nLine = 0;
+        for (size_t i = 0; i < nSize; i++) {
+            if (data[i] == '\n') {
+                if (nLine > w) w = nLine;
+                h++;
+                nLine = 0;
+            }
+            else if (data[i] != '\r') {
+                nLine++;
+            }
+        }
+        if (nLine > 0) {
+            if (nLine > w) w = nLine;
+            h++;
+        }
+
+        Reset(w, h);
+        int x = 0, y = 0;
+        for (size_t i = 0; i < nSize; i++) {
+            char c = data[i];
+            if (c == '\n') { x = 0; y++; continue; }
+            if (c == '\r') continue;
+            if (c == '#') cells.Set(x, y);
+            else if (c == '@') { nStartX = x; nStartY = y; }
+            x++;
+        }
+        BuildBlocks();
+    }
+
+    // Arquivo aberto para leitura: mapeado na memória a partir de 1 MB,
+    // lido inteiro para um buffer quando é pequeno.
+    class MappedFile {
+    public:
+        static const size_t nMapThreshold = 1 << 20;
+
+        ~MappedFile() { Close(); }
+
+        bool Open(const string& sPath, string& sError) {
+#ifdef _WIN32
+            hFile = CreateFileA(sPath.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+            if (hFile == INVALID_HANDLE_VALUE) {
+                sError = "não foi possível abrir " + sPath;
+                return false;
+            }
+            LARGE_INTEGER size;
+            GetFileSizeEx(hFile, &size);
+            nSize = (size_t)size.QuadPart;
+            if (nSize >= nMapThreshold) {
+                hMapping = CreateFileMappingA(hFile, NULL, PAGE_READONLY, 0, 0, NULL);
+                if (hMapping)
+                    pView = (const char*)MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0);
+                if (pView)
+                    return true;
+            }
+#else
+            int fd = open(sPath.c_str(), O_RDONLY);
+            if (fd < 0) {
+                sError = "não foi possível abrir " + sPath;
+                return false;
+            }
+            struct stat st;
+            nSize = fstat(fd, &st) == 0 ? (size_t)st.st_size : 0;
+            if (nSize >= nMapThreshold) {
+                void* p = mmap(NULL, nSize, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (p != MAP_FAILED) {
+                    madvise(p, nSize, MADV_SEQUENTIAL);
+                    pView = (const char*)p;
+                    close(fd);
+                    return true;
+                }
+            }
+            close(fd);
+#endif
+            // Arquivo pequeno (ou mapeamento indisponível): lê tudo para o buffer.
+            FILE* f = fopen(sPath.c_str(), "rb");
+            if (!f) {
+                sError = "não foi possível ler " + sPath;
+                return false;
+            }
+            buffer.resize(nSize);
+            nSize = fread(buffer.data(), 1, nSize, f);
+            fclose(f);
+            return true;
+        }
+
+        const char* Data() const { return pView ? pView : buffer.data(); }
+        size_t Size() const { return nSize; }
+
+    private:
+        void Close() {
+#ifdef _WIN32
+            if (pView) UnmapViewOfFile(pView);
+            if (hMapping) CloseHandle(hMapping);
+            if (hFile != INVALID_HANDLE_VALUE) CloseHandle(hFile);
+#else
+            if (pView) munmap((void*)pView, nSize);
+#endif
+            pView = nullptr;
+        }
+
+        const char* pView = nullptr;
+        size_t nSize = 0;
+        vector<char> buffer;
+#ifdef _WIN32
+        HANDLE hFile = INVALID_HANDLE_VALUE;
+        HANDLE hMapping = NULL;
+#endif
+    };
+};
@@ -0,0 +1,569 @@
+#pragma once
+
+#include <cmath>       // Biblioteca para sinf, cosf, floorf e fabsf.
+#include <cstdint>     // Tipos inteiros de tamanho fixo (int32_t).
+#include <string>
+#include <vector>
+using namespace std;
+
+#include "consolefps_raycast.h" // RayFace e o DDA escalar usado como referência.
+#include "consolefps_camera.h"  // Tabelas da câmera e limites de sombra.
+#include "consolefps_profile.h" // Tempo do lançamento e do sombreamento.
+
+// Modo de pacotes: lança 4, 8 ou 16 raios de colunas vizinhas de uma vez com
+// SSE2 ou AVX2, desligando as raias que já atingiram uma parede. O caminho
+// escalar faz exatamente as mesmas operações de ponto flutuante, raia a raia,
+// então os três caminhos geram frames idênticos bit a bit. Para manter isso,
+// não compile com contração para FMA (-ffp-contract=off junto com -mfma).
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define PACKET_HAS_X86 1
+#include <immintrin.h> // Intrínsecos SSE2 e AVX2.
+#ifdef _MSC_VER
+#include <intrin.h>    // __cpuid e _xgetbv.
+#endif
+#else
+#define PACKET_HAS_X86 0
+#endif
+
+// O MSVC aceita intrínsecos AVX2 sem flags; no GCC/Clang as funções AVX2 são
+// compiladas para esse alvo e só são chamadas se a CPU tiver suporte.
+#if defined(_MSC_VER)
+#define PACKET_TARGET_AVX2
+#else
+#define PACKET_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+const int nMaxPacketWidth = 16;  // Maior quantidade de raios em um pacote.
+
+// Conjunto de instruções usado pelos kernels de pacote.
+enum PacketIsa {
+    ISA_SCALAR,
+    ISA_SSE2,
+    ISA_AVX2
+};
+
+inline const char* PacketIsaName(PacketIsa isa) {
+    switch (isa) {
+        case ISA_SSE2: return "sse2";
+        case ISA_AVX2: return "avx2";
+        default:       return "escalar";
+    }
+}
+
+// Descobre em tempo de execução o melhor conjunto de instruções da CPU.
+inline PacketIsa DetectPacketIsa() {
+#if PACKET_HAS_X86 && defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    int nMaxLeaf = info[0];
+    __cpuid(info, 1);
+    bool bSse2 = (info[3] & (1 << 26)) != 0;
+    // AVX exige que o sistema operacional salve os registradores YMM (OSXSAVE + XCR0).
+    bool bOsAvx = (info[2] & (1 << 27)) && (info[2] & (1 << 28)) && (_xgetbv(0) & 6) == 6;
+    if (bOsAvx && nMaxLeaf >= 7) {
+        __cpuidex(info, 7, 0);
+        if (info[1] & (1 << 5))
+            return ISA_AVX2;
+    }
+    return bSse2 ? ISA_SSE2 : ISA_SCALAR;
+#elif PACKET_HAS_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        return ISA_AVX2;
+    if (__builtin_cpu_supports("sse2"))
+        return ISA_SSE2;
+    return ISA_SCALAR;
+#else
+    return ISA_SCALAR;
+#endif
+}
+
+// Raios de um pacote em estrutura de arrays. Cada kernel lê as direções
+// e escreve a distância, a face e a célula atingida de cada raia.
+// Cada array ocupa uma linha de cache, alinhada para as cargas SIMD.
+struct alignas(64) RayPacket {
+    float fEyeX[nMaxPacketWidth];        // Direção de cada raio no eixo X.
+    float fEyeY[nMaxPacketWidth];        // Direção de cada raio no eixo Y.
+    float fDistance[nMaxPacketWidth];    // Distância até a parede (fDepth se não atingiu).
+    int32_t nFace[nMaxPacketWidth];      // Face atingida (RayFace).
+    int32_t nCellX[nMaxPacketWidth];     // Célula atingida (-1 se não atingiu).
+    int32_t nCellY[nMaxPacketWidth];
+    float fTexCoord[nMaxPacketWidth];    // Coordenada de textura ao longo da face.
+    int nLanes = 0;                      // Quantidade de raias válidas.
+};
+
+// Calcula a direção dos raios das colunas [x0, x0 + nLanes) a partir das
+// tabelas da câmera, sem trigonometria.
+inline void PreparePacket(const CameraTables& cam, const CameraView& view, int x0, int nLanes, RayPacket& p) {
+    p.nLanes = nLanes;
+    for (int k = 0; k < nLanes; k++)
+        view.Ray(cam, x0 + k, p.fEyeX[k], p.fEyeY[k]);
+}
+
+// Face atingida a partir do eixo cruzado e do sentido do passo.
+inline int32_t PacketFace(bool bSideX, int nStepX, int nStepY) {
+    if (bSideX)
+        return nStepX > 0 ? FACE_WEST : FACE_EAST;
+    return nStepY > 0 ? FACE_NORTH : FACE_SOUTH;
+}
+
+// Coordenada de textura de cada raia, calculada depois do lançamento.
+// É comum a todos os kernels, então não afeta a igualdade entre eles.
+inline void FinishPacket(float fPosX, float fPosY, RayPacket& p) {
+    for (int k = 0; k < p.nLanes; k++) {
+        float fHit;
+        if (p.nFace[k] == FACE_WEST || p.nFace[k] == FACE_EAST)
+            fHit = fPosY + p.fEyeY[k] * p.fDistance[k];
+        else if (p.nFace[k] != FACE_NONE)
+            fHit = fPosX + p.fEyeX[k] * p.fDistance[k];
+        else
+            fHit = 0.0f;
+        p.fTexCoord[k] = fHit - floorf(fHit);
+    }
+}
+
+// Kernel escalar: o mesmo DDA de CastRayDDA, raia a raia. Serve como
+// referência para os kernels SIMD e atende pacotes incompletos.
+inline void CastPacketScalar(const GameMap& map, float fPosX, float fPosY, float fDepth, RayPacket& p) {
+    int nMapX0 = (int)floorf(fPosX);
+    int nMapY0 = (int)floorf(fPosY);
+    float fFracX0 = fPosX - (float)nMapX0;          // Distância até a borda anterior.
+    float fFracX1 = ((float)nMapX0 + 1.0f) - fPosX; // Distância até a borda seguinte.
+    float fFracY0 = fPosY - (float)nMapY0;
+    float fFracY1 = ((float)nMapY0 + 1.0f) - fPosY;
+
+    for (int k = 0; k < p.nLanes; k++) {
+        float fDeltaX = fabsf(1.0f / p.fEyeX[k]);
+        float fDeltaY = fabsf(1.0f / p.fEyeY[k]);
+        int nStepX = p.fEyeX[k] < 0.0f ? -1 : 1;
+        int nStepY = p.fEyeY[k] < 0.0f ? -1 : 1;
+        float fSideX = (p.fEyeX[k] < 0.0f ? fFracX0 : fFracX1) * fDeltaX;
+        float fSideY = (p.fEyeY[k] < 0.0f ? fFracY0 : fFracY1) * fDeltaY;
+        int nMapX = nMapX0, nMapY = nMapY0;
+
+        while (true) {
+            bool bSideX = fSideX < fSideY;
+            float fDistance;
+            if (bSideX) { fDistance = fSideX; fSideX += fDeltaX; nMapX += nStepX; }
+            else        { fDistance = fSideY; fSideY += fDeltaY; nMapY += nStepY; }
+
+            if (fDistance >= fDepth ||
+                nMapX < 0 || nMapX >= map.nWidth || nMapY < 0 || nMapY >= map.nHeight) {
+                p.fDistance[k] = fDepth;
+                p.nFace[k] = FACE_NONE;
+                p.nCellX[k] = p.nCellY[k] = -1;
+                break;
+            }
+            if (map.cells.Get(nMapX, nMapY)) {
+                p.fDistance[k] = fDistance;
+                p.nFace[k] = PacketFace(bSideX, nStepX, nStepY);
+                p.nCellX[k] = nMapX;
+                p.nCellY[k] = nMapY;
+                break;
+            }
+        }
+    }
+}
+
+// Kernel para mapas abertos (GameMap::UseBlockSkip): cada raia salta os
+// blocos vazios com CastRaySkip. Os saltos divergem muito entre raias
+// vizinhas, então não há versão SIMD; todos os conjuntos de instruções usam
+// este kernel nesses mapas e os frames continuam idênticos entre eles.
+inline void CastPacketSkip(const GameMap& map, float fPosX, float fPosY, float fDepth, RayPacket& p) {
+    for (int k = 0; k < p.nLanes; k++) {
+        RayHit hit = CastRaySkip(map, fPosX, fPosY, p.fEyeX[k], p.fEyeY[k], fDepth);
+        p.fDistance[k] = hit.fDistance;
+        p.nFace[k] = hit.nFace;
+        p.nCellX[k] = hit.nCellX;
+        p.nCellY[k] = hit.nCellY;
+    }
+}
+
+// Desenha o teto, a parede e o chão das colunas do pacote, raia a raia.
+// Fora da parede cada linha recebe o caractere de fundo da tabela da câmera.
+inline void ShadePacketScalar(const RayPacket& p, const wchar_t* background, wchar_t* screen,
+                              int nRowStride, int nScreenHeight, int x0, float fDepth) {
+    for (int k = 0; k < p.nLanes; k++) {
+        int nCeiling = CeilingRow(p.fDistance[k], nScreenHeight);
+        int nFloor = nScreenHeight - nCeiling;
+        wchar_t nShade = WallShade(p.fDistance[k], fDepth);
+        wchar_t* column = screen + x0 + k;
+        int y = 0;
+        for (; y < nCeiling; y++)
+            column[y * nRowStride] = background[y];
+        for (; y <= nFloor && y < nScreenHeight; y++)
+            column[y * nRowStride] = nShade;
+        for (; y < nScreenHeight; y++)
+            column[y * nRowStride] = background[y];
+    }
+}
+
+#if PACKET_HAS_X86
+
+// Kernel SSE2: NV vetores de 4 raias avançam juntos pelo grid. O SSE2 não
+// tem gather, então as consultas ao mapa das raias ativas são feitas uma a uma.
+template<int NV>
+inline void CastPacketSSE2(const GameMap& map, float fPosX, float fPosY, float fDepth, RayPacket& p) {
+    int nMapX0 = (int)floorf(fPosX);
+    int nMapY0 = (int)floorf(fPosY);
+    const __m128 vZero = _mm_setzero_ps();
+    const __m128 vOne = _mm_set1_ps(1.0f);
+    const __m128 vAbs = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+    const __m128 vFracX0 = _mm_set1_ps(fPosX - (float)nMapX0);
+    const __m128 vFracX1 = _mm_set1_ps(((float)nMapX0 + 1.0f) - fPosX);
+    const __m128 vFracY0 = _mm_set1_ps(fPosY - (float)nMapY0);
+    const __m128 vFracY1 = _mm_set1_ps(((float)nMapY0 + 1.0f) - fPosY);
+    const __m128 vDepth = _mm_set1_ps(fDepth);
+    const __m128i vOnes = _mm_set1_epi32(1);
+    const __m128i vMaxX = _mm_set1_epi32(map.nWidth - 1);
+    const __m128i vMaxY = _mm_set1_epi32(map.nHeight - 1);
+
+    __m128 sideX[NV], sideY[NV], deltaX[NV], deltaY[NV];
+    __m128i mapX[NV], mapY[NV], stepX[NV], stepY[NV], active[NV];
+    for (int v = 0; v < NV; v++) {
+        __m128 eyeX = _mm_load_ps(p.fEyeX + 4 * v);
+        __m128 eyeY = _mm_load_ps(p.fEyeY + 4 * v);
+        __m128 negX = _mm_cmplt_ps(eyeX, vZero);
+        __m128 negY = _mm_cmplt_ps(eyeY, vZero);
+        deltaX[v] = _mm_and_ps(_mm_div_ps(vOne, eyeX), vAbs);
+        deltaY[v] = _mm_and_ps(_mm_div_ps(vOne, eyeY), vAbs);
+        sideX[v] = _mm_mul_ps(_mm_or_ps(_mm_and_ps(negX, vFracX0), _mm_andnot_ps(negX, vFracX1)), deltaX[v]);
+        sideY[v] = _mm_mul_ps(_mm_or_ps(_mm_and_ps(negY, vFracY0), _mm_andnot_ps(negY, vFracY1)), deltaY[v]);
+        // Passo -1 onde a direção é negativa e +1 nas outras raias.
+        stepX[v] = _mm_or_si128(_mm_castps_si128(negX), vOnes);
+        stepY[v] = _mm_or_si128(_mm_castps_si128(negY), vOnes);
+        mapX[v] = _mm_set1_epi32(nMapX0);
+        mapY[v] = _mm_set1_epi32(nMapY0);
+        active[v] = _mm_set1_epi32(-1);
+    }
+
+    while (true) {
+        int nActive = 0;
+        for (int v = 0; v < NV; v++)
+            nActive |= _mm_movemask_ps(_mm_castsi128_ps(active[v]));
+        if (!nActive)
+            break;
+
+        for (int v = 0; v < NV; v++) {
+            // Avança cada raia para a próxima célula pela borda mais próxima.
+            __m128 bSideX = _mm_cmplt_ps(sideX[v], sideY[v]);
+            __m128i bSideXi = _mm_castps_si128(bSideX);
+            __m128 dist = _mm_or_ps(_mm_and_ps(bSideX, sideX[v]), _mm_andnot_ps(bSideX, sideY[v]));
+            sideX[v] = _mm_add_ps(sideX[v], _mm_and_ps(bSideX, deltaX[v]));
+            sideY[v] = _mm_add_ps(sideY[v], _mm_andnot_ps(bSideX, deltaY[v]));
+            mapX[v] = _mm_add_epi32(mapX[v], _mm_and_si128(bSideXi, stepX[v]));
+            mapY[v] = _mm_add_epi32(mapY[v], _mm_andnot_si128(bSideXi, stepY[v]));
+
+            // Raias que passaram de fDepth ou saíram do mapa.
+            __m128i outside = _mm_or_si128(
+                _mm_or_si128(_mm_cmplt_epi32(mapX[v], _mm_setzero_si128()), _mm_cmpgt_epi32(mapX[v], vMaxX)),
+                _mm_or_si128(_mm_cmplt_epi32(mapY[v], _mm_setzero_si128()), _mm_cmpgt_epi32(mapY[v], vMaxY)));
+            __m128i far = _mm_or_si128(_mm_castps_si128(_mm_cmpge_ps(dist, vDepth)), outside);
+
+            alignas(16) int32_t nX[4], nY[4], nFar[4], nActiveLane[4];
+            _mm_store_si128((__m128i*)nX, mapX[v]);
+            _mm_store_si128((__m128i*)nY, mapY[v]);
+            _mm_store_si128((__m128i*)nFar, far);
+            _mm_store_si128((__m128i*)nActiveLane, active[v]);
+            alignas(16) float fDist[4];
+            _mm_store_ps(fDist, dist);
+            int nSideX = _mm_movemask_ps(bSideX);
+
+            for (int i = 0; i < 4; i++) {
+                if (!nActiveLane[i])
+                    continue;
+                int k = 4 * v + i;
+                if (nFar[i]) {
+                    p.fDistance[k] = fDepth;
+                    p.nFace[k] = FACE_NONE;
+                    p.nCellX[k] = p.nCellY[k] = -1;
+                }
+                else if (map.cells.Get(nX[i], nY[i])) {
+                    p.fDistance[k] = fDist[i];
+                    p.nFace[k] = PacketFace((nSideX >> i) & 1, p.fEyeX[k] < 0.0f ? -1 : 1, p.fEyeY[k] < 0.0f ? -1 : 1);
+                    p.nCellX[k] = nX[i];
+                    p.nCellY[k] = nY[i];
+                }
+                else {
+                    continue;
+                }
+                nActiveLane[i] = 0;  // A raia terminou: desliga a máscara.
+            }
+            active[v] = _mm_load_si128((const __m128i*)nActiveLane);
+        }
+    }
+}
+
+// Kernel AVX2: NV vetores de 8 raias. As consultas ao mapa buscam com gather
+// a palavra de 32 bits de cada célula no grid de bits e isolam o bit com um
+// deslocamento variável. O gather tem máscara, então raias desligadas ou fora
+// do mapa não leem memória.
+template<int NV>
+PACKET_TARGET_AVX2 inline void CastPacketAVX2(const GameMap& map, float fPosX, float fPosY, float fDepth, RayPacket& p) {
+    int nMapX0 = (int)floorf(fPosX);
+    int nMapY0 = (int)floorf(fPosY);
+    const __m256 vZero = _mm256_setzero_ps();
+    const __m256 vOne = _mm256_set1_ps(1.0f);
+    const __m256 vAbs = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+    const __m256 vFracX0 = _mm256_set1_ps(fPosX - (float)nMapX0);
+    const __m256 vFracX1 = _mm256_set1_ps(((float)nMapX0 + 1.0f) - fPosX);
+    const __m256 vFracY0 = _mm256_set1_ps(fPosY - (float)nMapY0);
+    const __m256 vFracY1 = _mm256_set1_ps(((float)nMapY0 + 1.0f) - fPosY);
+    const __m256 vDepth = _mm256_set1_ps(fDepth);
+    const __m256i vOnes = _mm256_set1_epi32(1);
+    const __m256i vNegOne = _mm256_set1_epi32(-1);
+    const __m256i vWordsPerRow = _mm256_set1_epi32(map.cells.nWordsPerRow);
+    const __m256i vBitMask = _mm256_set1_epi32(31);
+    const __m256i vMaxX = _mm256_set1_epi32(map.nWidth - 1);
+    const __m256i vMaxY = _mm256_set1_epi32(map.nHeight - 1);
+    const __m256i vFaceWest = _mm256_set1_epi32(FACE_WEST), vFaceEast = _mm256_set1_epi32(FACE_EAST);
+    const __m256i vFaceNorth = _mm256_set1_epi32(FACE_NORTH), vFaceSouth = _mm256_set1_epi32(FACE_SOUTH);
+
+    __m256 sideX[NV], sideY[NV], deltaX[NV], deltaY[NV], distOut[NV];
+    __m256i mapX[NV], mapY[NV], stepX[NV], stepY[NV], active[NV], faceOut[NV], cellXOut[NV], cellYOut[NV];
+    for (int v = 0; v < NV; v++) {
+        __m256 eyeX = _mm256_load_ps(p.fEyeX + 8 * v);
+        __m256 eyeY = _mm256_load_ps(p.fEyeY + 8 * v);
+        __m256 negX = _mm256_cmp_ps(eyeX, vZero, _CMP_LT_OQ);
+        __m256 negY = _mm256_cmp_ps(eyeY, vZero, _CMP_LT_OQ);
+        deltaX[v] = _mm256_and_ps(_mm256_div_ps(vOne, eyeX), vAbs);
+        deltaY[v] = _mm256_and_ps(_mm256_div_ps(vOne, eyeY), vAbs);
+        sideX[v] = _mm256_mul_ps(_mm256_blendv_ps(vFracX1, vFracX0, negX), deltaX[v]);
+        sideY[v] = _mm256_mul_ps(_mm256_blendv_ps(vFracY1, vFracY0, negY), deltaY[v]);
+        stepX[v] = _mm256_or_si256(_mm256_castps_si256(negX), vOnes);
+        stepY[v] = _mm256_or_si256(_mm256_castps_si256(negY), vOnes);
+        mapX[v] = _mm256_set1_epi32(nMapX0);
+        mapY[v] = _mm256_set1_epi32(nMapY0);
+        active[v] = vNegOne;
+        distOut[v] = vDepth;
+        faceOut[v] = _mm256_set1_epi32(FACE_NONE);
+        cellXOut[v] = cellYOut[v] = vNegOne;
+    }
+
+    while (true) {
+        int nActive = 0;
+        for (int v = 0; v < NV; v++)
+            nActive |= _mm256_movemask_ps(_mm256_castsi256_ps(active[v]));
+        if (!nActive)
+            break;
+
+        for (int v = 0; v < NV; v++) {
+            // Avança cada raia para a próxima célula pela borda mais próxima.
+            __m256 bSideX = _mm256_cmp_ps(sideX[v], sideY[v], _CMP_LT_OQ);
+            __m256i bSideXi = _mm256_castps_si256(bSideX);
+            __m256 dist = _mm256_blendv_ps(sideY[v], sideX[v], bSideX);
+            sideX[v] = _mm256_add_ps(sideX[v], _mm256_and_ps(bSideX, deltaX[v]));
+            sideY[v] = _mm256_add_ps(sideY[v], _mm256_andnot_ps(bSideX, deltaY[v]));
+            mapX[v] = _mm256_add_epi32(mapX[v], _mm256_and_si256(bSideXi, stepX[v]));
+            mapY[v] = _mm256_add_epi32(mapY[v], _mm256_andnot_si256(bSideXi, stepY[v]));
+
+            // Raias que passaram de fDepth ou saíram do mapa.
+            __m256i outside = _mm256_or_si256(
+                _mm256_or_si256(_mm256_cmpgt_epi32(_mm256_setzero_si256(), mapX[v]), _mm256_cmpgt_epi32(mapX[v], vMaxX)),
+                _mm256_or_si256(_mm256_cmpgt_epi32(_mm256_setzero_si256(), mapY[v]), _mm256_cmpgt_epi32(mapY[v], vMaxY)));
+            __m256i far = _mm256_and_si256(active[v],
+                _mm256_or_si256(_mm256_castps_si256(_mm256_cmp_ps(dist, vDepth, _CMP_GE_OQ)), outside));
+
+            // Consulta o mapa só nas raias ativas que ainda estão dentro do mapa.
+            __m256i lookup = _mm256_andnot_si256(far, active[v]);
+            __m256i index = _mm256_add_epi32(_mm256_mullo_epi32(mapY[v], vWordsPerRow), _mm256_srli_epi32(mapX[v], 5));
+            __m256i word = _mm256_mask_i32gather_epi32(_mm256_setzero_si256(), (const int*)map.cells.words.data(), index, lookup, 4);
+            __m256i cell = _mm256_and_si256(_mm256_srlv_epi32(word, _mm256_and_si256(mapX[v], vBitMask)), vOnes);
+            __m256i wall = _mm256_and_si256(lookup, _mm256_cmpgt_epi32(cell, _mm256_setzero_si256()));
+
+            // Guarda o resultado das raias que acabaram de atingir uma parede.
+            __m256i face = _mm256_blendv_epi8(
+                _mm256_blendv_epi8(vFaceNorth, vFaceSouth, stepY[v]),
+                _mm256_blendv_epi8(vFaceWest, vFaceEast, stepX[v]), bSideXi);
+            distOut[v] = _mm256_blendv_ps(distOut[v], dist, _mm256_castsi256_ps(wall));
+            faceOut[v] = _mm256_blendv_epi8(faceOut[v], face, wall);
+            cellXOut[v] = _mm256_blendv_epi8(cellXOut[v], mapX[v], wall);
+            cellYOut[v] = _mm256_blendv_epi8(cellYOut[v], mapY[v], wall);
+
+            // Desliga as raias que terminaram (parede ou fim do alcance).
+            active[v] = _mm256_andnot_si256(_mm256_or_si256(far, wall), active[v]);
+        }
+    }
+
+    for (int v = 0; v < NV; v++) {
+        _mm256_store_ps(p.fDistance + 8 * v, distOut[v]);
+        _mm256_store_si256((__m256i*)(p.nFace + 8 * v), faceOut[v]);
+        _mm256_store_si256((__m256i*)(p.nCellX + 8 * v), cellXOut[v]);
+        _mm256_store_si256((__m256i*)(p.nCellY + 8 * v), cellYOut[v]);
+    }
+}
+
+// Grava 4 células de uma linha da tela (wchar_t tem 4 bytes no Linux e 2 no Windows).
+inline void StoreRowSSE2(wchar_t* dst, __m128i cells) {
+    if (sizeof(wchar_t) == 4)
+        _mm_storeu_si128((__m128i*)dst, cells);
+    else
+        _mm_storel_epi64((__m128i*)dst, _mm_packs_epi32(cells, cells));
+}
+
+// Desenha as colunas do pacote com SSE2: a linha do teto, a do chão e o
+// caractere da parede são calculados para 4 raias de uma vez, e cada linha
+// da tela recebe 4 células vizinhas com uma única escrita.
+template<int NV>
+inline void ShadePacketSSE2(const RayPacket& p, const wchar_t* background, wchar_t* screen,
+                            int nRowStride, int nScreenHeight, int x0, float fDepth) {
+    const __m128 vZero = _mm_setzero_ps();
+    const __m128 vHalf = _mm_set1_ps((float)(nScreenHeight / 2.0));
+    const __m128 vHeight = _mm_set1_ps((float)nScreenHeight);
+    const __m128i vSpace = _mm_set1_epi32(' ');
+
+    __m128i ceiling[NV], floorRow[NV], shade[NV];
+    for (int v = 0; v < NV; v++) {
+        __m128 dist = _mm_load_ps(p.fDistance + 4 * v);
+        __m128 fCeiling = _mm_max_ps(_mm_sub_ps(vHalf, _mm_div_ps(vHeight, dist)), vZero);
+        ceiling[v] = _mm_cvttps_epi32(fCeiling);
+        floorRow[v] = _mm_sub_epi32(_mm_set1_epi32(nScreenHeight), ceiling[v]);
+
+        // Limites de sombra aplicados do mais distante para o mais próximo.
+        __m128i s = vSpace;
+        __m128i m;
+        m = _mm_castps_si128(_mm_cmplt_ps(dist, _mm_set1_ps(fDepth)));
+        s = _mm_or_si128(_mm_and_si128(m, _mm_set1_epi32(0x2591)), _mm_andnot_si128(m, s));
+        m = _mm_castps_si128(_mm_cmplt_ps(dist, _mm_set1_ps(fDepth / 2.0f)));
+        s = _mm_or_si128(_mm_and_si128(m, _mm_set1_epi32(0x2592)), _mm_andnot_si128(m, s));
+        m = _mm_castps_si128(_mm_cmplt_ps(dist, _mm_set1_ps(fDepth / 3.0f)));
+        s = _mm_or_si128(_mm_and_si128(m, _mm_set1_epi32(0x2593)), _mm_andnot_si128(m, s));
+        m = _mm_castps_si128(_mm_cmple_ps(dist, _mm_set1_ps(fDepth / 4.0f)));
+        s = _mm_or_si128(_mm_and_si128(m, _mm_set1_epi32(0x2588)), _mm_andnot_si128(m, s));
+        shade[v] = s;
+    }
+
+    for (int y = 0; y < nScreenHeight; y++) {
+        __m128i vY = _mm_set1_epi32(y);
+        __m128i vBackground = _mm_set1_epi32(background[y]);
+        for (int v = 0; v < NV; v++) {
+            // Parede entre a linha do teto e a do chão; fundo nas outras linhas.
+            __m128i isWall = _mm_andnot_si128(_mm_cmplt_epi32(vY, ceiling[v]),
+                                              _mm_cmplt_epi32(vY, _mm_add_epi32(floorRow[v], _mm_set1_epi32(1))));
+            __m128i c = _mm_or_si128(_mm_and_si128(isWall, shade[v]), _mm_andnot_si128(isWall, vBackground));
+            StoreRowSSE2(screen + y * nRowStride + x0 + 4 * v, c);
+        }
+    }
+}
+
+// Grava 8 células de uma linha da tela.
+PACKET_TARGET_AVX2 inline void StoreRowAVX2(wchar_t* dst, __m256i cells) {
+    if (sizeof(wchar_t) == 4)
+        _mm256_storeu_si256((__m256i*)dst, cells);
+    else
+        _mm_storeu_si128((__m128i*)dst, _mm_packs_epi32(_mm256_castsi256_si128(cells), _mm256_extracti128_si256(cells, 1)));
+}
+
+// Desenha as colunas do pacote com AVX2, 8 raias por vetor.
+template<int NV>
+PACKET_TARGET_AVX2 inline void ShadePacketAVX2(const RayPacket& p, const wchar_t* background, wchar_t* screen,
+                                               int nRowStride, int nScreenHeight, int x0, float fDepth) {
+    const __m256 vZero = _mm256_setzero_ps();
+    const __m256 vHalf = _mm256_set1_ps((float)(nScreenHeight / 2.0));
+    const __m256 vHeight = _mm256_set1_ps((float)nScreenHeight);
+    const __m256i vSpace = _mm256_set1_epi32(' ');
+
+    __m256i ceiling[NV], floorRow[NV], shade[NV];
+    for (int v = 0; v < NV; v++) {
+        __m256 dist = _mm256_load_ps(p.fDistance + 8 * v);
+        __m256 fCeiling = _mm256_max_ps(_mm256_sub_ps(vHalf, _mm256_div_ps(vHeight, dist)), vZero);
+        ceiling[v] = _mm256_cvttps_epi32(fCeiling);
+        floorRow[v] = _mm256_sub_epi32(_mm256_set1_epi32(nScreenHeight), ceiling[v]);
+
+        // Limites de sombra aplicados do mais distante para o mais próximo.
+        __m256i s = vSpace;
+        s = _mm256_blendv_epi8(s, _mm256_set1_epi32(0x2591), _mm256_castps_si256(_mm256_cmp_ps(dist, _mm256_set1_ps(fDepth), _CMP_LT_OQ)));
+        s = _mm256_blendv_epi8(s, _mm256_set1_epi32(0x2592), _mm256_castps_si256(_mm256_cmp_ps(dist, _mm256_set1_ps(fDepth / 2.0f), _CMP_LT_OQ)));
+        s = _mm256_blendv_epi8(s, _mm256_set1_epi32(0x2593), _mm256_castps_si256(_mm256_cmp_ps(dist, _mm256_set1_ps(fDepth / 3.0f), _CMP_LT_OQ)));
+        s = _mm256_blendv_epi8(s, _mm256_set1_epi32(0x2588), _mm256_castps_si256(_mm256_cmp_ps(dist, _mm256_set1_ps(fDepth / 4.0f), _CMP_LE_OQ)));
+        shade[v] = s;
+    }
+
+    for (int y = 0; y < nScreenHeight; y++) {
+        __m256i vY = _mm256_set1_epi32(y);
+        __m256i vBackground = _mm256_set1_epi32(background[y]);
+        for (int v = 0; v < NV; v++) {
+            // Parede entre a linha do teto e a do chão; fundo nas outras linhas.
+            __m256i isWall = _mm256_andnot_si256(_mm256_cmpgt_epi32(ceiling[v], vY),
+                                                 _mm256_cmpgt_epi32(_mm256_add_epi32(floorRow[v], _mm256_set1_epi32(1)), vY));
+            __m256i c = _mm256_blendv_epi8(vBackground, shade[v], isWall);
+            StoreRowAVX2(screen + y * nRowStride + x0 + 8 * v, c);
+        }
+    }
+}
+
+#endif // PACKET_HAS_X86
+
+// Desenha colunas em pacotes de 4, 8 ou 16 raios com os kernels escolhidos
+// em tempo de execução. Pacotes incompletos no fim da faixa usam os kernels
+// escalares, que dão o mesmo resultado. Em mapas abertos os raios saltam os
+// blocos vazios (CastPacketSkip) e só o sombreamento usa SIMD.
+class PacketRenderer {
+public:
+    typedef void (*CastKernel)(const GameMap&, float, float, float, RayPacket&);
+    typedef void (*ShadeKernel)(const RayPacket&, const wchar_t*, wchar_t*, int, int, int, float);
+
+    PacketRenderer(int nPacketWidth, PacketIsa isaRequested) {
+        nWidth = nPacketWidth == 4 || nPacketWidth == 16 ? nPacketWidth : 8;
+        PacketIsa isaDetected = DetectPacketIsa();
+        isa = isaRequested < isaDetected ? isaRequested : isaDetected;
+        cast = CastPacketScalar;
+        shade = ShadePacketScalar;
+#if PACKET_HAS_X86
+        // Com 4 raias o AVX2 não tem o que fazer: usa SSE2.
+        if (isa == ISA_AVX2 && nWidth == 4)
+            isa = ISA_SSE2;
+        if (isa == ISA_AVX2) {
+            cast = nWidth == 8 ? CastPacketAVX2<1> : CastPacketAVX2<2>;
+            shade = nWidth == 8 ? ShadePacketAVX2<1> : ShadePacketAVX2<2>;
+        }
+        else if (isa == ISA_SSE2) {
+            cast = nWidth == 4 ? CastPacketSSE2<1> : nWidth == 8 ? CastPacketSSE2<2> : CastPacketSSE2<4>;
+            shade = nWidth == 4 ? ShadePacketSSE2<1> : nWidth == 8 ? ShadePacketSSE2<2> : ShadePacketSSE2<4>;
+        }
+#else
+        isa = ISA_SCALAR;
+#endif
+    }
+
+    int Width() const { return nWidth; }
+    PacketIsa Isa() const { return isa; }
+
+    // Desenha as colunas [x0, x1) num buffer com cam.nRowStride células por
+    // linha. As tabelas da câmera devem estar atualizadas.
+    void Render(const CameraTables& cam, const CameraView& view, const GameMap& map, wchar_t* screen,
+                float fPosX, float fPosY, float fDepth, int x0, int x1) const {
+        RayPacket p;
+        const wchar_t* background = cam.background.data();
+        bool bSkip = map.UseBlockSkip(fDepth);
+        ProfileSpan castSpan, shadeSpan;
+        for (int x = x0; x < x1; x += nWidth) {
+            int nLanes = x1 - x < nWidth ? x1 - x : nWidth;
+            castSpan.Begin();
+            PreparePacket(cam, view, x, nLanes, p);
+            if (bSkip)
+                CastPacketSkip(map, fPosX, fPosY, fDepth, p);
+            else if (nLanes == nWidth)
+                cast(map, fPosX, fPosY, fDepth, p);
+            else
+                CastPacketScalar(map, fPosX, fPosY, fDepth, p);
+            castSpan.End();
+
+            shadeSpan.Begin();
+            if (nLanes == nWidth)
+                shade(p, background, screen, cam.nRowStride, cam.nScreenHeight, x, fDepth);
+            else
+                ShadePacketScalar(p, background, screen, cam.nRowStride, cam.nScreenHeight, x, fDepth);
+            shadeSpan.End();
+        }
+        castSpan.Emit("raios");
+        shadeSpan.Emit("sombra");
+    }
+
+private:
+    int nWidth = 8;
+    PacketIsa isa = ISA_SCALAR;
+    CastKernel cast;
+    ShadeKernel shade;
+};
@@ -0,0 +1,297 @@
+#pragma once
+
+// Perfilador por etapa do frame. Só existe se compilado com
+// -DCONSOLEFPS_PROFILE; sem essa flag todas as classes abaixo ficam vazias,
+// as funções não fazem nada e PROFILE_SCOPE some, então o custo é zero.
+//
+// Cada thread grava os intervalos medidos (etapa, início, fim) no seu próprio
+// buffer circular, sem travas: só a thread dona escreve e só a thread
+// principal lê, uma vez por frame em Profiler::EndFrame(). Daí saem a média
+// de ms por etapa (para a sobreposição na tela) e, se pedido, os eventos do
+// arquivo JSON no formato trace_event do Chrome (chrome://tracing, Perfetto).
+
+#include <cstdint>     // Tipos inteiros de tamanho fixo (uint64_t).
+#include <cstdio>      // Escrita do arquivo JSON e da sobreposição.
+#include <string>
+#include <vector>
+using namespace std;
+
+#ifdef CONSOLEFPS_PROFILE
+
+#include <atomic>      // Índices do buffer circular e registro das threads.
+#include <chrono>      // Relógio estável e calibração do TSC.
+#include <cstring>     // strcmp dos nomes das etapas.
+#include <mutex>
+#include <thread>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define PROFILE_HAS_TSC 1
+#ifdef _MSC_VER
+#include <intrin.h>    // __rdtsc
+#else
+#include <x86intrin.h> // __rdtsc
+#endif
+#else
+#define PROFILE_HAS_TSC 0
+#endif
+
+// Marca de tempo em ticks: o contador de ciclos (TSC) em x86 e o relógio
+// estável, em nanossegundos, nas outras arquiteturas.
+inline uint64_t ProfileNow() {
+#if PROFILE_HAS_TSC
+    return __rdtsc();
+#else
+    return (uint64_t)chrono::duration_cast<chrono::nanoseconds>(
+        chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+// Intervalo medido por uma thread.
+struct ProfileEvent {
+    const char* sName;  // Nome da etapa (texto estático).
+    uint64_t nStart;    // Início em ticks.
+    uint64_t nEnd;      // Fim em ticks.
+};
+
+// Buffer circular de uma thread (um produtor, um consumidor). Se a thread
+// principal atrasar a leitura e o buffer encher, os eventos novos são
+// descartados em vez de sobrescrever os que ainda não foram lidos.
+struct alignas(64) ProfileRing {
+    static const uint32_t nCapacity = 1 << 14;
+
+    atomic<uint32_t> nHead{ 0 };  // Próxima posição a escrever (só a dona altera).
+    alignas(64) atomic<uint32_t> nTail{ 0 };  // Próxima posição a ler (só a principal altera).
+    int nThreadIndex = 0;
+    ProfileEvent events[nCapacity];
+
+    void Push(const char* sName, uint64_t nStart, uint64_t nEnd) {
+        uint32_t nH = nHead.load(memory_order_relaxed);
+        if (nH - nTail.load(memory_order_acquire) >= nCapacity)
+            return;
+        events[nH & (nCapacity - 1)] = { sName, nStart, nEnd };
+        nHead.store(nH + 1, memory_order_release);
+    }
+};
+
+class Profiler {
+public:
+    static const int nMaxThreads = 64;
+    static const int nMaxStages = 16;
+    static const size_t nMaxTraceEvents = 1 << 20;  // Limite de eventos no JSON.
+
+    static Profiler& Instance() {
+        static Profiler profiler;
+        return profiler;
+    }
+
+    // Buffer da thread atual, criado no primeiro uso. Threads além de
+    // nMaxThreads não são medidas.
+    ProfileRing* Ring() {
+        thread_local ProfileRing* pRing = Register();
+        return pRing;
+    }
+
+    void Record(const char* sName, uint64_t nStart, uint64_t nEnd) {
+        if (ProfileRing* pRing = Ring())
+            pRing->Push(sName, nStart, nEnd);
+    }
+
+    // Passa a guardar os eventos lidos para ExportChromeTrace().
+    void EnableTrace() { bTrace = true; }
+
+    // Fecha um frame: esvazia os buffers de todas as threads, soma os ms de
+    // cada etapa no frame e atualiza as médias mostradas na sobreposição.
+    void EndFrame() {
+        uint64_t nNow = ProfileNow();
+        double fFrameMs = nLastFrame ? TicksToMs(nNow - nLastFrame) : 0.0;
+        nLastFrame = nNow;
+
+        for (auto& stage : stages)
+            stage.fFrameMs = 0.0;
+        int nRings = nRingCount.load(memory_order_acquire);
+        for (int i = 0; i < nRings; i++) {
+            ProfileRing* pRing = rings[i];
+            uint32_t nT = pRing->nTail.load(memory_order_relaxed);
+            uint32_t nH = pRing->nHead.load(memory_order_acquire);
+            for (; nT != nH; nT++) {
+                const ProfileEvent& e = pRing->events[nT & (ProfileRing::nCapacity - 1)];
+                if (Stage* pStage = FindStage(e.sName))
+                    pStage->fFrameMs += TicksToMs(e.nEnd - e.nStart);
+                if (bTrace && trace.size() < nMaxTraceEvents)
+                    trace.push_back({ e, pRing->nThreadIndex });
+            }
+            pRing->nTail.store(nT, memory_order_release);
+        }
+
+        // Média móvel exponencial, para a sobreposição não tremer.
+        const float fAlpha = 0.1f;
+        for (auto& stage : stages)
+            stage.fAverageMs += fAlpha * (stage.fFrameMs - stage.fAverageMs);
+        if (fFrameMs > 0.0)
+            fAverageFrameMs += fAlpha * (fFrameMs - fAverageFrameMs);
+    }
+
+    // Escreve FPS e ms por etapa na primeira linha da tela. As etapas feitas
+    // pelas threads somam o tempo de todas elas.
+    void DrawOverlay(wchar_t* screen, int nScreenWidth) const {
+        char sText[256];
+        int n = snprintf(sText, sizeof(sText), "FPS %.1f", fAverageFrameMs > 0.0 ? 1000.0 / fAverageFrameMs : 0.0);
+        for (auto& stage : stages)
+            if (n < (int)sizeof(sText))
+                n += snprintf(sText + n, sizeof(sText) - n, " | %s %.2f ms", stage.sName, stage.fAverageMs);
+        for (int i = 0; sText[i] && i < nScreenWidth; i++)
+            screen[i] = (wchar_t)(unsigned char)sText[i];
+    }
+
+    // Grava os eventos guardados em JSON no formato trace_event do Chrome
+    // (eventos completos "X", com início e duração em microssegundos).
+    bool ExportChromeTrace(const string& sPath) const {
+        FILE* f = fopen(sPath.c_str(), "w");
+        if (!f)
+            return false;
+        uint64_t nOrigin = trace.empty() ? 0 : trace[0].event.nStart;
+        for (auto& t : trace)
+            if (t.event.nStart < nOrigin)
+                nOrigin = t.event.nStart;
+        fprintf(f, "{\"traceEvents\":[\n");
+        for (size_t i = 0; i < trace.size(); i++) {
+            const ProfileEvent& e = trace[i].event;
+            fprintf(f, "{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}%s\n",
+                    e.sName, trace[i].nThread, TicksToMs(e.nStart - nOrigin) * 1000.0,
+                    TicksToMs(e.nEnd - e.nStart) * 1000.0, i + 1 < trace.size() ? "," : "");
+        }
+        fprintf(f, "],\"displayTimeUnit\":\"ms\"}\n");
+        fclose(f);
+        return true;
+    }
+
+    static bool Enabled() { return true; }
+
+private:
+    struct Stage {
+        const char* sName;
+        double fFrameMs = 0.0;
+        double fAverageMs = 0.0;
+    };
+    struct TraceEvent {
+        ProfileEvent event;
+        int nThread;
+    };
+
+    Profiler() {
+        // Mede quantos ticks do TSC cabem em um milissegundo.
+#if PROFILE_HAS_TSC
+        auto tp1 = chrono::steady_clock::now();
+        uint64_t nTicks1 = ProfileNow();
+        this_thread::sleep_for(chrono::milliseconds(20));
+        auto tp2 = chrono::steady_clock::now();
+        uint64_t nTicks2 = ProfileNow();
+        fTicksPerMs = (nTicks2 - nTicks1) / chrono::duration<double, milli>(tp2 - tp1).count();
+#else
+        fTicksPerMs = 1e6;
+#endif
+    }
+
+    ~Profiler() {
+        for (int i = 0; i < nRingCount.load(); i++)
+            delete rings[i];
+    }
+
+    ProfileRing* Register() {
+        lock_guard<mutex> lock(mtxRegister);
+        int n = nRingCount.load(memory_order_relaxed);
+        if (n >= nMaxThreads)
+            return nullptr;
+        ProfileRing* pRing = new ProfileRing();
+        pRing->nThreadIndex = n;
+        rings[n] = pRing;
+        nRingCount.store(n + 1, memory_order_release);
+        return pRing;
+    }
+
+    // Etapas na ordem em que apareceram pela primeira vez. Compara o texto:
+    // literais iguais em arquivos diferentes não têm garantia de dividir o
+    // mesmo endereço.
+    Stage* FindStage(const char* sName) {
+        for (auto& stage : stages)
+            if (stage.sName == sName || strcmp(stage.sName, sName) == 0)
+                return &stage;
+        if ((int)stages.size() >= nMaxStages)
+            return nullptr;
+        stages.push_back({ sName });
+        return &stages.back();
+    }
+
+    double TicksToMs(uint64_t nTicks) const { return (double)nTicks / fTicksPerMs; }
+
+    double fTicksPerMs = 1.0;
+    mutex mtxRegister;
+    ProfileRing* rings[nMaxThreads] = {};
+    atomic<int> nRingCount{ 0 };
+    vector<Stage> stages;
+    vector<TraceEvent> trace;
+    bool bTrace = false;
+    uint64_t nLastFrame = 0;
+    double fAverageFrameMs = 0.0;
+};
+
+// Mede o intervalo entre a construção e a destruição.
+class ProfileScope {
+public:
+    explicit ProfileScope(const char* sName) : sName(sName), nStart(ProfileNow()) {}
+    ~ProfileScope() { Profiler::Instance().Record(sName, nStart, ProfileNow()); }
+
+private:
+    const char* sName;
+    uint64_t nStart;
+};
+
+// Soma vários trechos curtos de uma mesma etapa (por exemplo, o lançamento
+// de cada pacote de raios) e grava um único evento com o total, começando no
+// início do primeiro trecho.
+class ProfileSpan {
+public:
+    void Begin() {
+        nMark = ProfileNow();
+        if (!nStart)
+            nStart = nMark;
+    }
+    void End() { nTicks += ProfileNow() - nMark; }
+    void Emit(const char* sName) {
+        if (nStart)
+            Profiler::Instance().Record(sName, nStart, nStart + nTicks);
+    }
+
+private:
+    uint64_t nStart = 0;
+    uint64_t nMark = 0;
+    uint64_t nTicks = 0;
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(name)
+
+#else
+
+// Versões vazias: compilam para nada.
+class Profiler {
+public:
+    static Profiler& Instance() { static Profiler profiler; return profiler; }
+    void EnableTrace() {}
+    void EndFrame() {}
+    void DrawOverlay(wchar_t*, int) const {}
+    bool ExportChromeTrace(const string&) const { return false; }
+    static bool Enabled() { return false; }
+};
+
+class ProfileSpan {
+public:
+    void Begin() {}
+    void End() {}
+    void Emit(const char*) {}
+};
+
+#define PROFILE_SCOPE(name) ((void)0)
+
+#endif
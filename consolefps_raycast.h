@@ -0,0 +1,213 @@
+#pragma once
+
+#include <cmath>       // Biblioteca para funções matemáticas (floorf, fabsf).
+using namespace std;
+
+#include "consolefps_map.h" // Grid de paredes em bits e níveis de blocos.
+
+// Face da célula atingida pelo raio. Oeste/leste são as faces de x constante
+// (x menor / x maior) e norte/sul as de y constante (y menor / y maior).
+enum RayFace {
+    FACE_NONE = -1,  // O raio não atingiu nada até fDepth.
+    FACE_WEST,
+    FACE_EAST,
+    FACE_NORTH,
+    FACE_SOUTH
+};
+
+// Resultado do lançamento de um raio.
+struct RayHit {
+    float fDistance = 0.0f;   // Distância até a parede (fDepth se não atingiu nada).
+    RayFace nFace = FACE_NONE; // Face da parede atingida.
+    float fTexCoord = 0.0f;   // Coordenada de textura ao longo da face, em [0, 1).
+    int nCellX = -1;          // Célula atingida no eixo X.
+    int nCellY = -1;          // Célula atingida no eixo Y.
+    int nSteps = 0;           // Quantidade de consultas ao mapa feitas pelo raio.
+    bool bHitWall = false;    // Se o raio atingiu uma parede.
+};
+
+// Preenche o resultado de um raio que atingiu a célula (nMapX, nMapY) pela
+// borda de x constante (bSideX) ou de y constante. A coordenada de textura é
+// a posição do impacto ao longo da face.
+inline void SetRayHit(RayHit& hit, float fPosX, float fPosY, float fEyeX, float fEyeY, float fDistance,
+                      int nMapX, int nMapY, bool bSideX, int nStepX, int nStepY) {
+    hit.bHitWall = true;
+    hit.fDistance = fDistance;
+    hit.nCellX = nMapX;
+    hit.nCellY = nMapY;
+    float fHit;
+    if (bSideX) {
+        hit.nFace = nStepX > 0 ? FACE_WEST : FACE_EAST;
+        fHit = fPosY + fEyeY * fDistance;
+    }
+    else {
+        hit.nFace = nStepY > 0 ? FACE_NORTH : FACE_SOUTH;
+        fHit = fPosX + fEyeX * fDistance;
+    }
+    hit.fTexCoord = fHit - floorf(fHit);
+}
+
+// Lança um raio avançando em passos fixos (algoritmo original do jogo).
+// Custa até fDepth / fStep consultas ao mapa e pode atravessar cantos finos.
+inline RayHit CastRayMarch(const GameMap& map, float fPosX, float fPosY, float fEyeX, float fEyeY,
+                           float fDepth, float fStep = 0.1f) {
+    RayHit hit;
+    while (!hit.bHitWall && hit.fDistance < fDepth) {
+        hit.fDistance += fStep;  // Incrementa a distância
+        hit.nSteps++;
+
+        int nTestX = (int)(fPosX + fEyeX * hit.fDistance);
+        int nTestY = (int)(fPosY + fEyeY * hit.fDistance);
+
+        // Se o raio ultrapassar os limites do mapa, assume que atingiu o "infinito".
+        if (!map.InBounds(nTestX, nTestY)) {
+            hit.fDistance = fDepth;
+            return hit;
+        }
+
+        // Verifica se o raio atingiu uma parede.
+        if (map.cells.Get(nTestX, nTestY)) {
+            hit.bHitWall = true;
+            hit.nCellX = nTestX;
+            hit.nCellY = nTestY;
+        }
+    }
+    if (!hit.bHitWall)
+        hit.fDistance = fDepth;
+    return hit;
+}
+
+// Lança um raio percorrendo o grid célula a célula (DDA). Cada célula cruzada
+// pelo raio é visitada exatamente uma vez, então o custo depende do número de
+// células atravessadas e não de fDepth. A direção (fEyeX, fEyeY) deve ser
+// unitária para que a distância retornada seja euclidiana.
+inline RayHit CastRayDDA(const GameMap& map, float fPosX, float fPosY, float fEyeX, float fEyeY,
+                         float fDepth) {
+    RayHit hit;
+
+    int nMapX = (int)floorf(fPosX);  // Célula atual do raio.
+    int nMapY = (int)floorf(fPosY);
+
+    // Distância percorrida pelo raio para atravessar uma célula inteira em cada eixo.
+    float fDeltaX = fEyeX != 0.0f ? fabsf(1.0f / fEyeX) : HUGE_VALF;
+    float fDeltaY = fEyeY != 0.0f ? fabsf(1.0f / fEyeY) : HUGE_VALF;
+
+    // Direção do passo e distância até a primeira borda de célula em cada eixo.
+    int nStepX, nStepY;
+    float fSideX, fSideY;
+    if (fEyeX < 0.0f) { nStepX = -1; fSideX = (fPosX - nMapX) * fDeltaX; }
+    else              { nStepX =  1; fSideX = (nMapX + 1.0f - fPosX) * fDeltaX; }
+    if (fEyeY < 0.0f) { nStepY = -1; fSideY = (fPosY - nMapY) * fDeltaY; }
+    else              { nStepY =  1; fSideY = (nMapY + 1.0f - fPosY) * fDeltaY; }
+
+    while (true) {
+        // Avança para a próxima célula pela borda mais próxima.
+        bool bSideX = fSideX < fSideY;
+        float fDistance;
+        if (bSideX) { fDistance = fSideX; fSideX += fDeltaX; nMapX += nStepX; }
+        else        { fDistance = fSideY; fSideY += fDeltaY; nMapY += nStepY; }
+
+        // Passou da profundidade máxima ou saiu do mapa: não atingiu nada.
+        if (fDistance >= fDepth || !map.InBounds(nMapX, nMapY)) {
+            hit.fDistance = fDepth;
+            return hit;
+        }
+
+        hit.nSteps++;
+        if (map.cells.Get(nMapX, nMapY)) {
+            SetRayHit(hit, fPosX, fPosY, fEyeX, fEyeY, fDistance, nMapX, nMapY, bSideX, nStepX, nStepY);
+            return hit;
+        }
+    }
+}
+
+// Lança um raio como o DDA, mas atravessa áreas vazias de uma vez: se a célula
+// atual está num bloco de 8x8 sem paredes (ou de 64x64, se ele também estiver
+// vazio), o raio salta direto para a primeira célula fora do bloco. Em mapas
+// abertos o custo cai de uma consulta por célula para uma por bloco; com
+// pilares espalhados os saltos são curtos e o DDA é mais rápido (veja
+// GameMap::UseBlockSkip e CastRay).
+inline RayHit CastRaySkip(const GameMap& map, float fPosX, float fPosY, float fEyeX, float fEyeY,
+                          float fDepth) {
+    RayHit hit;
+
+    int nMapX = (int)floorf(fPosX);
+    int nMapY = (int)floorf(fPosY);
+    float fDeltaX = fEyeX != 0.0f ? fabsf(1.0f / fEyeX) : HUGE_VALF;
+    float fDeltaY = fEyeY != 0.0f ? fabsf(1.0f / fEyeY) : HUGE_VALF;
+    int nStepX = fEyeX < 0.0f ? -1 : 1;
+    int nStepY = fEyeY < 0.0f ? -1 : 1;
+
+    // Distância até a próxima borda de célula em cada eixo, a partir da célula atual.
+    auto nextSideX = [&] { return (nStepX > 0 ? nMapX + 1.0f - fPosX : fPosX - nMapX) * fDeltaX; };
+    auto nextSideY = [&] { return (nStepY > 0 ? nMapY + 1.0f - fPosY : fPosY - nMapY) * fDeltaY; };
+    float fSideX = nextSideX();
+    float fSideY = nextSideY();
+
+    while (true) {
+        hit.nSteps++;
+        bool bInside = map.InBounds(nMapX, nMapY);
+        if (bInside && !map.blocks.Get(nMapX >> GameMap::nBlockShift, nMapY >> GameMap::nBlockShift)) {
+            // Bloco vazio: usa o bloco grande se ele também estiver vazio.
+            int nShift = map.largeBlocks.Get(nMapX >> GameMap::nLargeBlockShift, nMapY >> GameMap::nLargeBlockShift)
+                ? GameMap::nBlockShift : GameMap::nLargeBlockShift;
+            int nSize = 1 << nShift;
+            int nBlockX = (nMapX >> nShift) << nShift;
+            int nBlockY = (nMapY >> nShift) << nShift;
+
+            // Distância até a saída do bloco em cada eixo.
+            float fExitX = (nStepX > 0 ? nBlockX + nSize - fPosX : fPosX - nBlockX) * fDeltaX;
+            float fExitY = (nStepY > 0 ? nBlockY + nSize - fPosY : fPosY - nBlockY) * fDeltaY;
+            bool bSideX = fExitX < fExitY;
+            float fDistance;
+            if (bSideX) {
+                fDistance = fExitX;
+                nMapX = nStepX > 0 ? nBlockX + nSize : nBlockX - 1;
+                int nY = (int)floorf(fPosY + fEyeY * fDistance);
+                nMapY = nY < nBlockY ? nBlockY : nY >= nBlockY + nSize ? nBlockY + nSize - 1 : nY;
+            }
+            else {
+                fDistance = fExitY;
+                nMapY = nStepY > 0 ? nBlockY + nSize : nBlockY - 1;
+                int nX = (int)floorf(fPosX + fEyeX * fDistance);
+                nMapX = nX < nBlockX ? nBlockX : nX >= nBlockX + nSize ? nBlockX + nSize - 1 : nX;
+            }
+
+            if (fDistance >= fDepth || !map.InBounds(nMapX, nMapY)) {
+                hit.fDistance = fDepth;
+                return hit;
+            }
+            if (map.cells.Get(nMapX, nMapY)) {
+                SetRayHit(hit, fPosX, fPosY, fEyeX, fEyeY, fDistance, nMapX, nMapY, bSideX, nStepX, nStepY);
+                return hit;
+            }
+            fSideX = nextSideX();
+            fSideY = nextSideY();
+            continue;
+        }
+
+        // Bloco com paredes: avança uma célula como no DDA.
+        bool bSideX = fSideX < fSideY;
+        float fDistance;
+        if (bSideX) { fDistance = fSideX; fSideX += fDeltaX; nMapX += nStepX; }
+        else        { fDistance = fSideY; fSideY += fDeltaY; nMapY += nStepY; }
+
+        if (fDistance >= fDepth || !map.InBounds(nMapX, nMapY)) {
+            hit.fDistance = fDepth;
+            return hit;
+        }
+        if (map.cells.Get(nMapX, nMapY)) {
+            SetRayHit(hit, fPosX, fPosY, fEyeX, fEyeY, fDistance, nMapX, nMapY, bSideX, nStepX, nStepY);
+            return hit;
+        }
+    }
+}
+
+// Lança um raio com o motor mais rápido para o mapa: saltos sobre blocos
+// vazios em mapas abertos, DDA nos outros.
+inline RayHit CastRay(const GameMap& map, float fPosX, float fPosY, float fEyeX, float fEyeY,
+                      float fDepth) {
+    if (map.UseBlockSkip(fDepth))
+        return CastRaySkip(map, fPosX, fPosY, fEyeX, fEyeY, fDepth);
+    return CastRayDDA(map, fPosX, fPosY, fEyeX, fEyeY, fDepth);
+}
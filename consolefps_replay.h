@@ -0,0 +1,151 @@
+#pragma once
+
+#include <algorithm>   // sort() para os percentis.
+#include <cctype>      // toupper() nas teclas do roteiro.
+#include <cstdint>     // Tipos inteiros de tamanho fixo (uint64_t).
+#include <cstdio>      // Leitura e escrita dos arquivos de roteiro e de hashes.
+#include <string>
+#include <vector>
+using namespace std;
+
+// Teclas de movimento pressionadas num frame.
+struct PlayerInput {
+    bool bLeft = false;     // 'A': gira para a esquerda.
+    bool bRight = false;    // 'D': gira para a direita.
+    bool bForward = false;  // 'W': anda para frente.
+    bool bBack = false;     // 'S': anda para trás.
+};
+
+// Roteiro de teclas para rodar o jogo sem console: uma entrada por frame.
+// No arquivo, cada linha é "<frames> <teclas>", com as teclas entre A, D, W
+// e S (ou '-' para nenhuma); linhas vazias e começadas por ';' são ignoradas.
+// Exemplo: "120 D" gira para a direita por 120 frames.
+class InputTrace {
+public:
+    // Roteiro padrão: gira, anda até a parede, recua girando e fica parado.
+    static InputTrace Default() {
+        InputTrace trace;
+        trace.Append(120, "D");
+        trace.Append(180, "W");
+        trace.Append(60, "SA");
+        trace.Append(60, "");
+        return trace;
+    }
+
+    // Lê o roteiro de um arquivo. Retorna false e preenche sError se falhar.
+    bool LoadFromFile(const string& sPath, string& sError) {
+        FILE* f = fopen(sPath.c_str(), "r");
+        if (!f) {
+            sError = "não foi possível abrir " + sPath;
+            return false;
+        }
+        frames.clear();
+        char sLine[256];
+        int nLine = 0;
+        while (fgets(sLine, sizeof(sLine), f)) {
+            nLine++;
+            int nCount = 0;
+            char sKeys[64] = "";
+            if (sLine[0] == ';' || sscanf(sLine, "%d %63s", &nCount, sKeys) < 1)
+                continue;
+            if (nCount < 0) {
+                sError = sPath + ":" + to_string(nLine) + ": número de frames inválido";
+                fclose(f);
+                return false;
+            }
+            Append(nCount, sKeys);
+        }
+        fclose(f);
+        if (frames.empty()) {
+            sError = sPath + ": a gravação não tem nenhum frame";
+            return false;
+        }
+        return true;
+    }
+
+    // Acrescenta nCount frames com as teclas de sKeys pressionadas.
+    void Append(int nCount, const string& sKeys) {
+        PlayerInput input;
+        for (char c : sKeys) {
+            c = (char)toupper((unsigned char)c);
+            input.bLeft |= c == 'A';
+            input.bRight |= c == 'D';
+            input.bForward |= c == 'W';
+            input.bBack |= c == 'S';
+        }
+        frames.insert(frames.end(), nCount, input);
+    }
+
+    int Frames() const { return (int)frames.size(); }
+    const PlayerInput& operator[](int i) const { return frames[i]; }
+
+private:
+    vector<PlayerInput> frames;
+};
+
+// Hash FNV-1a de 64 bits de um frame. As células entram como 32 bits para
+// que o hash seja o mesmo com wchar_t de 2 bytes (Windows) ou 4 (Linux).
+inline uint64_t HashFrame(const wchar_t* screen, int nCells) {
+    uint64_t nHash = 14695981039346656037ull;
+    for (int i = 0; i < nCells; i++) {
+        uint32_t c = (uint32_t)screen[i];
+        for (int b = 0; b < 4; b++) {
+            nHash ^= (c >> (8 * b)) & 0xFF;
+            nHash *= 1099511628211ull;
+        }
+    }
+    return nHash;
+}
+
+// Tempos de frame de uma execução, com percentis por ordenação.
+struct FrameTimes {
+    vector<double> ms;
+
+    // Percentil p (0 a 100) pelo método do posto mais próximo.
+    double Percentile(double p) const {
+        if (ms.empty())
+            return 0.0;
+        vector<double> sorted = ms;
+        sort(sorted.begin(), sorted.end());
+        size_t i = (size_t)(p / 100.0 * (sorted.size() - 1) + 0.5);
+        return sorted[i];
+    }
+
+    double Total() const {
+        double fTotal = 0.0;
+        for (double f : ms)
+            fTotal += f;
+        return fTotal;
+    }
+};
+
+// Grava os hashes de cada frame, um por linha em hexadecimal.
+inline bool SaveFrameHashes(const string& sPath, const vector<uint64_t>& hashes) {
+    FILE* f = fopen(sPath.c_str(), "w");
+    if (!f)
+        return false;
+    for (uint64_t nHash : hashes)
+        fprintf(f, "%016llx\n", (unsigned long long)nHash);
+    fclose(f);
+    return true;
+}
+
+// Compara os hashes com os de um arquivo gravado antes. Retorna o primeiro
+// frame diferente, -1 se todos forem iguais ou -2 se o arquivo não abrir.
+inline int CompareFrameHashes(const string& sPath, const vector<uint64_t>& hashes) {
+    FILE* f = fopen(sPath.c_str(), "r");
+    if (!f)
+        return -2;
+    int nFrame = 0;
+    unsigned long long nHash;
+    while (nFrame < (int)hashes.size() && fscanf(f, "%llx", &nHash) == 1) {
+        if (nHash != hashes[nFrame])
+            break;
+        nFrame++;
+    }
+    bool bExtra = fscanf(f, "%llx", &nHash) == 1;
+    fclose(f);
+    if (nFrame == (int)hashes.size() && !bExtra)
+        return -1;
+    return nFrame;
+}
@@ -1,48 +1,52 @@
+#include <chrono>
+#include <cstdio>
 #include <iostream>
 #include <string>
 using namespace std;
 
 #include "olcConsoleGameEngine.h" // Inclui a biblioteca da engine de console
+#include "flappybird_sim.h"       // Física e colisão, sem depender da tela
+#include "flappybird_batch.h"     // Milhares de partidas em lote, com SIMD e threads
+#include "flappybird_record.h"    // Gravação das telas em segundo plano e reprodução
+#include "flappybird_render.h"    // Preenchimento SIMD e apagamento só do que mudou
 
 // Definição da classe que herda da olcConsoleGameEngine
 class OneLoneCoder_FlappyBird : public olcConsoleGameEngine {
     public:
-        // Construtor, define o nome do jogo
-        OneLoneCoder_FlappyBird(){
+        // Construtor, define o nome do jogo e a semente dos obstáculos
+        explicit OneLoneCoder_FlappyBird(uint32_t nSeed, FrameRecorder* pRecorder = nullptr) : nSeed(nSeed), pRecorder(pRecorder) {
             m_sAppName = L"Flappy Bird"; 
         }
     
     private:
-        // Variáveis relacionadas ao comportamento do pássaro
-        float fBirdPosition = 0.0f;     // Posição vertical do pássaro
-        float fBirdVelocity = 0.0f;     // Velocidade do pássaro (para cima/baixo)
-        float fBirdAcceleration = 0.0f; // Aceleração do pássaro (afetada pela gravidade)
+        // Regras do jogo (dependem do tamanho da tela) e estado do pássaro e
+        // dos obstáculos
+        FlappySim sim{ 80, 48 };
+        FlappyState state;
+        FlappyRenderer renderer{ 80, 48 }; // Desenha o estado direto em m_bufScreen
+        uint32_t nSeed; // A mesma semente repete a mesma sequência de obstáculos
+        FrameRecorder* pRecorder; // Grava cada frame desenhado, se não for nulo
 
-        // Constante da gravidade que afeta o movimento do pássaro
-        float fGravity = 100.0f; 
-        
-        // Largura de uma seção (um segmento de obstáculo) e a lista que representa os obstáculos
-        float fSectionWidth; 
-        list<int> listSection; // Armazena as posições dos obstáculos
-        float fLevelPosition = 0.0f; // Posição horizontal do nível (scroll)
+        // A física anda em passos fixos de FlappySim::fTimeStep; o tempo do
+        // frame que sobra fica acumulado para o próximo
+        float fAccumulator = 0.0f;
+        bool bFlapRequested = false; // Espaço apertado, esperando o próximo passo
 
-        // Variáveis de controle de colisão e reinício do jogo
-        bool bHasCollided = false; 
+        // Variáveis de controle de reinício do jogo
         bool bResetGame = false; 
         
         // Contadores para tentativas e batidas de asas
         int nAttemptCount = 0;   // Contador de tentativas
-        int nFlapCount = 0;      // Quantidade de vezes que o pássaro bateu asas
         int nMaxFlapCount = 0;   // Máximo número de batidas de asas em uma tentativa
 	
     protected:
         // Método chamado quando o jogo é inicializado (sobrescreve método da engine)
         virtual bool OnUserCreate() {
-            // Inicializa as seções dos obstáculos (4 seções iniciais)
-            listSection = { 0, 0, 0, 0 };
+            // Calcula a largura das seções e a posição do pássaro com base no tamanho da tela
+            sim = FlappySim(ScreenWidth(), ScreenHeight());
+            renderer = FlappyRenderer(ScreenWidth(), ScreenHeight());
+            sim.Start(state, nSeed);
             bResetGame = true; // Sinaliza que o jogo deve começar/resetar
-            // Calcula a largura de uma seção com base no tamanho da tela
-            fSectionWidth = (float)ScreenWidth() / (float)(listSection.size() - 1);
             return true;
         }
         
@@ -51,97 +55,287 @@ class OneLoneCoder_FlappyBird : public olcConsoleGameEngine {
             // Se o jogo está sendo reiniciado
             if (bResetGame) {
                 // Reseta todas as variáveis para começar de novo
-                bHasCollided = false;
                 bResetGame = false;
-                listSection = { 0, 0, 0, 0 }; // Zera as seções
-                fBirdAcceleration = 0.0f;
-                fBirdVelocity = 0.0f;
-                fBirdPosition = ScreenHeight() / 2.0f; // Posição inicial do pássaro (meio da tela)
-                nFlapCount = 0;
+                sim.Reset(state);
+                fAccumulator = 0.0f;
+                bFlapRequested = false;
                 nAttemptCount++; // Incrementa o número de tentativas
             }
             
             // Se houve colisão, aguarda o jogador reiniciar
-            if (bHasCollided) {
+            if (state.bHasCollided) {
                 if (m_keys[VK_SPACE].bReleased)
                     bResetGame = true; // Reinicia quando a barra de espaço for solta
+                if (pRecorder)
+                    pRecorder->Capture(m_bufScreen, {}); // Tela parada: um frame vazio
+                return true;
             }
-            else {
-                // Lógica de movimentação do pássaro
-                if (m_keys[VK_SPACE].bPressed && fBirdVelocity >= fGravity / 10.0f) {
-                    fBirdAcceleration = 0.0f;
-                    fBirdVelocity = -fGravity / 4.0f; // Bate asa (movimenta para cima)
-                    nFlapCount++; // Conta uma batida de asa
-                    if (nFlapCount > nMaxFlapCount)
-                        nMaxFlapCount = nFlapCount; // Atualiza pontuação máxima se aplicável
-                } else {
-                    // Acelera o pássaro para baixo (gravidade)
-                    fBirdAcceleration += fGravity * fElapsedTime;
-                }
-            
-                if (fBirdAcceleration >= fGravity)
-                    fBirdAcceleration = fGravity; // Limita a aceleração pela gravidade
-            
-                fBirdVelocity += fBirdAcceleration * fElapsedTime; // Atualiza velocidade
-                fBirdPosition += fBirdVelocity * fElapsedTime; // Atualiza a posição
-                fLevelPosition += 14.0f * fElapsedTime; // Move o nível para a esquerda
-            
-                // Gera novas seções de obstáculos quando o nível avança
-                if (fLevelPosition > fSectionWidth) {
-                    fLevelPosition -= fSectionWidth; // Move a posição do nível
-                    listSection.pop_front(); // Remove a seção mais à esquerda
-                    int i = rand() % (ScreenHeight() - 20); // Gera um novo obstáculo
-                    if (i <= 10) i = 0; // Define o tamanho mínimo dos obstáculos
-                    listSection.push_back(i); // Adiciona nova seção
-                }
-            
-                // Limpa a tela
-                Fill(0, 0, ScreenWidth(), ScreenHeight(), L' ');
-            
-                // Desenha os obstáculos
-                int nSection = 0;
-                for (auto s : listSection) {
-                    if (s != 0) {
-                        // Desenha a parte inferior do obstáculo
-                        Fill(nSection * fSectionWidth + 10 - fLevelPosition, ScreenHeight() - s, nSection * fSectionWidth + 15 - fLevelPosition, ScreenHeight(), PIXEL_SOLID, FG_GREEN);
-                        // Desenha a parte superior do obstáculo
-                        Fill(nSection * fSectionWidth + 10 - fLevelPosition, 0, nSection * fSectionWidth + 15 - fLevelPosition, ScreenHeight() - s - 15, PIXEL_SOLID, FG_GREEN);
-                    }
-                    nSection++; // Próxima seção
-                }
-            
-                // Posição horizontal do pássaro (estático horizontalmente)
-                int nBirdX = (int)(ScreenWidth() / 3.0f);
-            
-                // Detecção de colisão (com o chão, teto ou obstáculos)
-                bHasCollided = fBirdPosition < 2 || fBirdPosition > ScreenHeight() - 2 || // Checa se o pássaro saiu da tela
-                    m_bufScreen[(int)(fBirdPosition + 0) * ScreenWidth() + nBirdX].Char.UnicodeChar != L' ' || // Colisão parte superior
-                    m_bufScreen[(int)(fBirdPosition + 1) * ScreenWidth() + nBirdX].Char.UnicodeChar != L' ' || // Colisão parte inferior
-                    m_bufScreen[(int)(fBirdPosition + 0) * ScreenWidth() + nBirdX + 6].Char.UnicodeChar != L' ' || // Colisão parte traseira
-                    m_bufScreen[(int)(fBirdPosition + 1) * ScreenWidth() + nBirdX + 6].Char.UnicodeChar != L' '; // Colisão parte frontal
-            
-                // Desenha o pássaro na tela
-                if (fBirdVelocity > 0) { // Se o pássaro está descendo
-                    DrawString(nBirdX, fBirdPosition + 0, L"\\\\\\");    // Parte superior
-                    DrawString(nBirdX, fBirdPosition + 1, L"<\\\\\\=Q"); // Parte inferior
-                } else { // Se o pássaro está subindo
-                    DrawString(nBirdX, fBirdPosition + 0, L"<///=Q");
-                    DrawString(nBirdX, fBirdPosition + 1, L"///");
-                }
-            
-                // Exibe a pontuação na tela
-                DrawString(1, 1, L"Tentativa: " + to_wstring(nAttemptCount) + L" Pontuação: " + to_wstring(nFlapCount) + L" Pontuação Máxima: " + to_wstring(nMaxFlapCount));
+
+            // Simulação em passos fixos; a batida de asa vale para o primeiro
+            // passo depois do aperto. Frames muito lentos não viram uma fila
+            // de passos: no máximo um quarto de segundo é simulado por frame.
+            if (m_keys[VK_SPACE].bPressed)
+                bFlapRequested = true;
+            fAccumulator = min(fAccumulator + fElapsedTime, 0.25f);
+            while (fAccumulator >= FlappySim::fTimeStep && !state.bHasCollided) {
+                sim.Step(state, bFlapRequested);
+                bFlapRequested = false;
+                fAccumulator -= FlappySim::fTimeStep;
             }
+            if (state.nFlapCount > nMaxFlapCount)
+                nMaxFlapCount = state.nFlapCount; // Atualiza pontuação máxima se aplicável
+
+            // Desenho: só lê o estado da simulação. Apaga o que foi desenhado
+            // no frame anterior e desenha os obstáculos, o pássaro e a
+            // pontuação.
+            renderer.Draw(m_bufScreen, sim, state, L"Tentativa: " + to_wstring(nAttemptCount) + L" Pontuação: " + to_wstring(state.nFlapCount) + L" Pontuação Máxima: " + to_wstring(nMaxFlapCount));
+
+            // Grava só as regiões que o desenho mudou
+            if (pRecorder)
+                pRecorder->Capture(m_bufScreen, renderer.Dirty());
             
             return true; // Continua o jogo
         }
 };
 
+// Piloto simples para o benchmark: bate asa quando o pássaro passa do meio
+// da abertura do próximo cano (ou do meio da tela, se não houver cano).
+bool AutoFlap(const FlappySim& sim, const FlappyState& s) {
+    float fTarget = sim.Height() / 2.0f;
+    for (int nSection = 0; nSection < s.sections.Size(); nSection++) {
+        int h = s.sections[nSection];
+        int nX1, nX2;
+        sim.PipeColumns(s, nSection, nX1, nX2);
+        if (nX2 > sim.BirdX()) {
+            if (h != 0) {
+                int nTopEnd, nBottomStart;
+                sim.PipeRows(h, nTopEnd, nBottomStart);
+                fTarget = (nTopEnd + nBottomStart) / 2.0f - 1.0f;
+            }
+            break;
+        }
+    }
+    return s.fBirdPosition > fTarget;
+}
+
+// Roda a simulação sem console, o mais rápido possível, e mostra passos por
+// segundo. Cada colisão reinicia a tentativa.
+void RunSimBenchmark(long long nSteps) {
+    FlappySim sim(80, 48);
+    FlappyState state;
+    sim.Start(state, 1);
+
+    long long nAttempts = 1, nFlaps = 0;
+    auto tp1 = chrono::steady_clock::now();
+    for (long long i = 0; i < nSteps; i++) {
+        if (sim.Step(state, AutoFlap(sim, state))) {
+            nFlaps += state.nFlapCount;
+            sim.Reset(state);
+            nAttempts++;
+        }
+    }
+    auto tp2 = chrono::steady_clock::now();
+    double fSeconds = chrono::duration<double>(tp2 - tp1).count();
+    printf("%lld passos em %.3f s: %.2f M passos/s (%.1f s de jogo)\n", nSteps, fSeconds,
+           nSteps / fSeconds / 1e6, nSteps * FlappySim::fTimeStep);
+    printf("%lld tentativas, média de %.1f batidas de asa\n", nAttempts, (double)nFlaps / nAttempts);
+}
+
+// Mede o desenho de uma partida em telas maiores que 80x48: apagando a tela
+// inteira a cada frame (escalar e SSE2) e apagando só os retângulos do frame
+// anterior. Confere se os três caminhos geram as mesmas telas.
+void RunRenderBenchmark() {
+    const int nFrames = 2000;
+    printf("%-10s %-22s %12s %16s\n", "tela", "caminho", "us/frame", "células/frame");
+    for (auto size : { make_pair(80, 48), make_pair(320, 192), make_pair(1280, 480) }) {
+        int nWidth = size.first, nHeight = size.second;
+        FlappySim sim(nWidth, nHeight);
+        vector<CHAR_INFO> reference((size_t)nWidth * nHeight), screen(reference.size());
+        struct Path { const char* sName; bool bSimd, bDirty; };
+        int nMismatch = 0;
+        for (Path path : { Path{ "tela inteira, escalar", false, false }, Path{ "tela inteira, sse2", true, false }, Path{ "retângulos, sse2", true, true } }) {
+            FlappyRenderer renderer(nWidth, nHeight), check(nWidth, nHeight);
+            renderer.bSimd = path.bSimd;
+            renderer.bDirty = path.bDirty;
+            check.bSimd = check.bDirty = false;
+            FlappyState state;
+            sim.Start(state, 1);
+            double fSeconds = 0.0;
+            size_t nCells = 0;
+            for (int f = 0; f < nFrames; f++) {
+                if (sim.Step(state, AutoFlap(sim, state)))
+                    sim.Reset(state);
+                wstring sText = L"Pontuação: " + to_wstring(state.nFlapCount);
+                auto tp1 = chrono::steady_clock::now();
+                renderer.Draw(screen.data(), sim, state, sText);
+                auto tp2 = chrono::steady_clock::now();
+                fSeconds += chrono::duration<double>(tp2 - tp1).count();
+                nCells += renderer.CellsWritten();
+                if (path.bDirty && f % 16 == 0) {
+                    check.Draw(reference.data(), sim, state, sText);
+                    nMismatch += memcmp(reference.data(), screen.data(), screen.size() * sizeof(CHAR_INFO)) != 0;
+                }
+            }
+            printf("%4dx%-5d %-22s %12.2f %16zu\n", nWidth, nHeight, path.sName, fSeconds / nFrames * 1e6, nCells / nFrames);
+        }
+        if (nMismatch)
+            printf("  %d frames diferentes da tela inteira!\n", nMismatch);
+    }
+}
+
+// Quantos passos a partida s sobrevive nas próximas nDepth decisões de
+// nRepeat passos cada (bater asa no primeiro passo ou não), por busca em
+// profundidade. Cada ramo parte de uma cópia do estado na pilha: o snapshot
+// é a própria cópia, e o estado original nunca é alterado.
+int Lookahead(const FlappySim& sim, const FlappyState& s, int nDepth, int nRepeat, long long& nClones) {
+    if (nDepth == 0)
+        return 0;
+    int nBest = 0;
+    for (int nAction = 1; nAction >= 0; nAction--) {
+        FlappyState child = s;
+        nClones++;
+        int nSurvived = 0;
+        while (nSurvived < nRepeat && !sim.Step(child, nAction && nSurvived == 0))
+            nSurvived++;
+        if (nSurvived == nRepeat)
+            nSurvived += Lookahead(sim, child, nDepth - 1, nRepeat, nClones);
+        nBest = max(nBest, nSurvived);
+        if (nBest == nDepth * nRepeat)
+            break; // Sobrevive até o horizonte: não precisa testar o outro ramo
+    }
+    return nBest;
+}
+
+// Joga partidas com a busca acima decidindo cada passo e mede quantos
+// estados são clonados por segundo. A partida pode ser repetida a partir da
+// semente: a mesma semente dá a mesma pontuação.
+void RunSearchBenchmark(int nGames) {
+    const int nDepth = 10, nRepeat = 6, nMaxSteps = 20000;
+    FlappySim sim(80, 48);
+    long long nClones = 0, nSteps = 0;
+    auto tp1 = chrono::steady_clock::now();
+    for (int g = 0; g < nGames; g++) {
+        FlappyState state;
+        sim.Start(state, (uint32_t)g + 1);
+        int n = 0;
+        for (; n < nMaxSteps && !state.bHasCollided; n++) {
+            // Compara bater asa agora ou não, cada um a partir de um snapshot
+            FlappyState flap = state, glide = state;
+            nClones += 2;
+            bool bFlapDies = sim.Step(flap, true), bGlideDies = sim.Step(glide, false);
+            int nFlap = bFlapDies ? -1 : Lookahead(sim, flap, nDepth, nRepeat, nClones);
+            int nGlide = bGlideDies ? -1 : Lookahead(sim, glide, nDepth, nRepeat, nClones);
+            state = nFlap > nGlide ? flap : glide; // Restaura o melhor
+        }
+        nSteps += n;
+        printf("partida %d: %d passos, %d batidas de asa%s\n", g + 1, n, state.nFlapCount,
+               state.bHasCollided ? "" : " (sem bater)");
+    }
+    auto tp2 = chrono::steady_clock::now();
+    double fSeconds = chrono::duration<double>(tp2 - tp1).count();
+    printf("%lld snapshots em %.3f s: %.2f M/s, %zu bytes cada\n", nClones, fSeconds, nClones / fSeconds / 1e6, sizeof(FlappyState));
+}
+
+// Mede passos de ambiente por segundo do lote: escalar e SSE2 com uma
+// thread, e SSE2 com todas as threads. As ações vêm de uma regra fixa sobre
+// a posição (fora do tempo medido). No fim confere se os caminhos escalar e
+// SIMD chegaram ao mesmo estado.
+void RunBatchBenchmark(int nInstances) {
+    const int nSteps = 2000;
+    int nThreads = max(1, (int)thread::hardware_concurrency());
+    printf("%d partidas, %d passos\n", nInstances, nSteps);
+    printf("%-10s %8s %14s %12s\n", "caminho", "threads", "M passos/s", "tentativas");
+
+    vector<uint8_t> nAction(nInstances);
+    auto run = [&](FlappyBatch& batch, bool bSimd, const char* sName) {
+        double fSeconds = 0.0;
+        long long nEpisodes = 0;
+        for (int s = 0; s < nSteps; s++) {
+            float fFlapBelow = batch.Rules().Height() * (0.45f + 0.1f * (s % 7) / 7.0f);
+            for (int i = 0; i < nInstances; i++)
+                nAction[i] = batch.fBirdPosition[i] > fFlapBelow;
+            auto tp1 = chrono::steady_clock::now();
+            batch.Step(nAction.data(), bSimd);
+            auto tp2 = chrono::steady_clock::now();
+            fSeconds += chrono::duration<double>(tp2 - tp1).count();
+            for (int i = 0; i < nInstances; i++)
+                nEpisodes += batch.nDone[i];
+        }
+        printf("%-10s %8d %14.2f %12lld\n", sName, batch.Threads(), (double)nInstances * nSteps / fSeconds / 1e6, nEpisodes);
+    };
+
+    FlappyBatch scalar(nInstances, 80, 48, 1, 1);
+    run(scalar, false, "escalar");
+    FlappyBatch simd(nInstances, 80, 48, 1, 1);
+    run(simd, true, "sse2");
+    if (nThreads > 1) {
+        FlappyBatch parallel(nInstances, 80, 48, 1, nThreads);
+        run(parallel, true, "sse2");
+    }
+
+    int nMismatch = 0;
+    for (int i = 0; i < nInstances; i++)
+        nMismatch += scalar.fBirdPosition[i] != simd.fBirdPosition[i] || scalar.nSectionHeight[3][i] != simd.nSectionHeight[3][i] ||
+                     scalar.nFlapCount[i] != simd.nFlapCount[i] || scalar.nLastScore[i] != simd.nLastScore[i];
+    printf("partidas diferentes entre escalar e sse2: %d\n", nMismatch);
+}
+
 // Função principal do jogo
-int main() {
-    OneLoneCoder_FlappyBird game; // Instancia o jogo
+int main(int argc, char* argv[]) {
+    uint32_t nSeed = (uint32_t)chrono::steady_clock::now().time_since_epoch().count(); // Sem --seed, uma partida diferente a cada execução
+    string sRecordPath; // --record: arquivo da gravação
+    for (int i = 1; i < argc; i++) {
+        string sArg = argv[i];
+        if (sArg == "--bench-sim") {
+            RunSimBenchmark(i + 1 < argc ? atoll(argv[i + 1]) : 10000000);
+            return 0;
+        }
+        if (sArg == "--bench-render") {
+            RunRenderBenchmark();
+            return 0;
+        }
+        if (sArg == "--bench-search") {
+            RunSearchBenchmark(i + 1 < argc ? max(1, atoi(argv[i + 1])) : 4);
+            return 0;
+        }
+        if (sArg == "--bench-batch") {
+            RunBatchBenchmark(i + 1 < argc ? max(1, atoi(argv[i + 1])) : 16384);
+            return 0;
+        }
+        if (sArg == "--play" && i + 1 < argc) {
+            // Reproduz uma gravação no terminal; a velocidade opcional
+            // multiplica a original (0: o mais rápido possível)
+            string sError;
+            if (!PlayRecording(argv[i + 1], i + 2 < argc ? atof(argv[i + 2]) : 1.0, sError)) {
+                fprintf(stderr, "%s\n", sError.c_str());
+                return 1;
+            }
+            return 0;
+        }
+        if (sArg == "--seed" && i + 1 < argc)
+            nSeed = (uint32_t)strtoul(argv[++i], nullptr, 10);
+        else if (sArg == "--record" && i + 1 < argc)
+            sRecordPath = argv[++i];
+    }
+
+    // Gravação opcional da partida ("-" manda para a saída padrão)
+    FrameRecorder recorder;
+    if (!sRecordPath.empty()) {
+        string sError;
+        if (!recorder.Open(sRecordPath, 80, 48, sError)) {
+            fprintf(stderr, "%s\n", sError.c_str());
+            return 1;
+        }
+    }
+
+    OneLoneCoder_FlappyBird game(nSeed, recorder.IsOpen() ? &recorder : nullptr); // Instancia o jogo
     game.ConstructConsole(80, 48, 16, 16); // Define as dimensões da janela do console
     game.Start(); // Inicia o jogo
+
+    if (recorder.IsOpen()) {
+        recorder.Close();
+        recorder.PrintStats(stderr);
+    }
     
     return 0;
 }
@@ -0,0 +1,255 @@
+#pragma once
+
+// Ambiente em lote: milhares de partidas de Flappy Bird avançando juntas,
+// para treinar e avaliar agentes. O estado fica em estrutura de arrays (um
+// vetor por campo, uma posição por partida), o passo processa 4 partidas
+// por instrução SSE2 e as faixas de partidas são divididas entre threads.
+// Partidas que batem recomeçam sozinhas no mesmo passo.
+//
+// As regras e o gerador dos canos são os de FlappySim: a partida i do lote
+// é igual a um FlappyState começado com a semente nSeed + i e as mesmas
+// ações. O caminho escalar faz as mesmas operações de ponto flutuante que o
+// SSE2, então os dois geram estados idênticos bit a bit.
+
+#include <cstdint>     // Tipos inteiros de tamanho fixo (uint32_t).
+#include <vector>
+using namespace std;
+
+#include "flappybird_sim.h"     // Constantes do jogo.
+#include "workers.h"            // Conjunto de threads com roubo de faixas.
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define BATCH_HAS_SSE2 1
+#include <immintrin.h> // Intrínsecos SSE2.
+#else
+#define BATCH_HAS_SSE2 0
+#endif
+
+class FlappyBatch {
+public:
+    static const int nLanes = 4;     // Partidas por vetor SSE2
+    static const int nChunk = 1024;  // Partidas por faixa de trabalho das threads
+
+    // nInstances partidas numa tela de nWidth x nHeight; a semente define a
+    // sequência de canos de todas elas (cada partida tem o seu gerador).
+    FlappyBatch(int nInstances, int nWidth, int nHeight, uint32_t nSeed, int nThreads = 1)
+        : sim(nWidth, nHeight), nInstances(nInstances), workers(nThreads) {
+        size_t n = Padded();
+        fBirdPosition.resize(n);
+        fBirdVelocity.resize(n);
+        fBirdAcceleration.resize(n);
+        fLevelPosition.assign(n, 0.0f);
+        for (auto& section : nSectionHeight)
+            section.resize(n);
+        nRandom.resize(n);
+        nFlapCount.resize(n);
+        nEpisodeSteps.resize(n);
+        nDone.assign(n, 0);
+        fReward.assign(n, 0.0f);
+        nLastScore.assign(n, 0);
+        for (size_t i = 0; i < n; i++) {
+            nRandom[i] = FlappySim::Seed(nSeed + (uint32_t)i);
+            ResetLane(i);
+        }
+    }
+
+    FlappyBatch(const FlappyBatch&) = delete;
+    FlappyBatch& operator=(const FlappyBatch&) = delete;
+
+    int Instances() const { return nInstances; }
+    int Threads() const { return workers.ThreadCount(); }
+    const FlappySim& Rules() const { return sim; }
+
+    // Avança todas as partidas um passo. nAction[i] != 0 bate a asa da
+    // partida i. Depois do passo, nDone[i] diz se ela bateu (e já foi
+    // reiniciada), fReward[i] vale 1 se sobreviveu e 0 se bateu, e
+    // nLastScore[i] guarda as batidas de asa da tentativa que terminou.
+    void Step(const uint8_t* nAction, bool bSimd = true) {
+        workers.Run(nInstances, nChunk, [&](int i0, int i1) {
+#if BATCH_HAS_SSE2
+            if (bSimd) {
+                for (int i = i0; i < i1; i += nLanes)
+                    StepSSE2(i, nAction);
+                return;
+            }
+#endif
+            (void)bSimd;
+            for (int i = i0; i < i1; i++)
+                StepScalar(i, nAction[i] != 0);
+        });
+    }
+
+    // Estado por partida, para observação. As últimas posições (até um
+    // múltiplo de nLanes) são preenchimento e não contam.
+    vector<float> fBirdPosition;
+    vector<float> fBirdVelocity;
+    vector<float> fBirdAcceleration;
+    vector<float> fLevelPosition;
+    vector<int32_t> nSectionHeight[FlappySim::nSections]; // [seção][partida], 0: sem cano
+    vector<uint32_t> nRandom;
+    vector<int32_t> nFlapCount;
+    vector<int32_t> nEpisodeSteps;
+
+    // Resultado do último Step()
+    vector<int32_t> nDone;
+    vector<float> fReward;
+    vector<int32_t> nLastScore;
+
+private:
+    size_t Padded() const { return (size_t)(nInstances + nLanes - 1) / nLanes * nLanes; }
+
+    void ResetLane(size_t i) {
+        fBirdPosition[i] = sim.Height() / 2.0f;
+        fBirdVelocity[i] = 0.0f;
+        fBirdAcceleration[i] = 0.0f;
+        for (auto& section : nSectionHeight)
+            section[i] = 0;
+        nFlapCount[i] = 0;
+        nEpisodeSteps[i] = 0;
+    }
+
+    // Caminho escalar, de referência: FlappySim::Step sobre uma raia.
+    void StepScalar(int i, bool bFlap) {
+        const float fGravity = FlappySim::fGravity, fDt = FlappySim::fTimeStep;
+        float fAcc = fBirdAcceleration[i], fVel = fBirdVelocity[i];
+        if (bFlap && fVel >= fGravity / 10.0f) {
+            fAcc = 0.0f;
+            fVel = -fGravity / 4.0f;
+            nFlapCount[i]++;
+        } else {
+            fAcc += fGravity * fDt;
+        }
+        if (fAcc >= fGravity)
+            fAcc = fGravity;
+        fVel += fAcc * fDt;
+        float fPos = fBirdPosition[i] + fVel * fDt;
+        float fLevel = fLevelPosition[i] + FlappySim::fScrollSpeed * fDt;
+
+        if (fLevel > sim.SectionWidth()) {
+            fLevel -= sim.SectionWidth();
+            for (int k = 0; k + 1 < FlappySim::nSections; k++)
+                nSectionHeight[k][i] = nSectionHeight[k + 1][i];
+            nRandom[i] = FlappySim::NextRandom(nRandom[i]);
+            nSectionHeight[FlappySim::nSections - 1][i] = sim.SectionHeight(nRandom[i]);
+        }
+        fBirdAcceleration[i] = fAcc;
+        fBirdVelocity[i] = fVel;
+        fBirdPosition[i] = fPos;
+        fLevelPosition[i] = fLevel;
+        nEpisodeSteps[i]++;
+
+        // Mesma colisão de FlappySim::Collides
+        bool bHit = fPos < 2 || fPos > sim.Height() - 2;
+        int nRow0 = (int)fPos, nRow1 = nRow0 + FlappySim::nBirdHeight;
+        int nCol0 = sim.BirdX(), nCol1 = nCol0 + FlappySim::nBirdWidth;
+        for (int k = 0; k < FlappySim::nSections && !bHit; k++) {
+            int h = nSectionHeight[k][i];
+            int nX1 = (int)(k * sim.SectionWidth() + FlappySim::nPipeLeft - fLevel);
+            int nX2 = (int)(k * sim.SectionWidth() + FlappySim::nPipeRight - fLevel);
+            int nTopEnd = sim.Height() - h - FlappySim::nGapHeight, nBottomStart = sim.Height() - h;
+            bHit = h != 0 && nX1 < nCol1 && nCol0 < nX2 && (nRow0 < nTopEnd || nRow1 > nBottomStart);
+        }
+
+        nDone[i] = bHit;
+        fReward[i] = bHit ? 0.0f : 1.0f;
+        if (bHit) {
+            nLastScore[i] = nFlapCount[i];
+            ResetLane(i);
+        }
+    }
+
+#if BATCH_HAS_SSE2
+    static __m128 Select(__m128 mask, __m128 a, __m128 b) {
+        return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+    }
+    static __m128i Select(__m128i mask, __m128i a, __m128i b) {
+        return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+    }
+    static __m128i LoadI(const void* p) { return _mm_loadu_si128((const __m128i*)p); }
+    static void StoreI(void* p, __m128i v) { _mm_storeu_si128((__m128i*)p, v); }
+
+    // As 4 partidas a partir de i, com máscaras no lugar dos ifs.
+    void StepSSE2(int i, const uint8_t* nAction) {
+        const __m128 vGravity = _mm_set1_ps(FlappySim::fGravity);
+        const __m128 vDt = _mm_set1_ps(FlappySim::fTimeStep);
+        const __m128i vZero = _mm_setzero_si128(), vOne = _mm_set1_epi32(1);
+
+        // Ações das 4 partidas (as de preenchimento não batem asa)
+        int32_t nFlap[nLanes];
+        for (int l = 0; l < nLanes; l++)
+            nFlap[l] = i + l < nInstances && nAction[i + l] ? -1 : 0;
+        __m128 vFlap = _mm_castsi128_ps(LoadI(nFlap));
+
+        __m128 vAcc = _mm_loadu_ps(&fBirdAcceleration[i]);
+        __m128 vVel = _mm_loadu_ps(&fBirdVelocity[i]);
+        __m128 vFlapOk = _mm_and_ps(vFlap, _mm_cmpge_ps(vVel, _mm_set1_ps(FlappySim::fGravity / 10.0f)));
+        vAcc = Select(vFlapOk, _mm_setzero_ps(), _mm_add_ps(vAcc, _mm_mul_ps(vGravity, vDt)));
+        vVel = Select(vFlapOk, _mm_set1_ps(-FlappySim::fGravity / 4.0f), vVel);
+        __m128i vFlaps = _mm_sub_epi32(LoadI(&nFlapCount[i]), _mm_castps_si128(vFlapOk));
+        vAcc = Select(_mm_cmpge_ps(vAcc, vGravity), vGravity, vAcc);
+        vVel = _mm_add_ps(vVel, _mm_mul_ps(vAcc, vDt));
+        __m128 vPos = _mm_add_ps(_mm_loadu_ps(&fBirdPosition[i]), _mm_mul_ps(vVel, vDt));
+        __m128 vLevel = _mm_add_ps(_mm_loadu_ps(&fLevelPosition[i]), _mm_mul_ps(_mm_set1_ps(FlappySim::fScrollSpeed), vDt));
+
+        // Seção nova nas raias em que o nível andou uma seção inteira (o
+        // mesmo xorshift e a mesma conta de FlappySim::SectionHeight)
+        __m128 vSectionWidth = _mm_set1_ps(sim.SectionWidth());
+        __m128 vScroll = _mm_cmpgt_ps(vLevel, vSectionWidth);
+        __m128i vScrollI = _mm_castps_si128(vScroll);
+        vLevel = Select(vScroll, _mm_sub_ps(vLevel, vSectionWidth), vLevel);
+        __m128i vSection[FlappySim::nSections];
+        for (int k = 0; k < FlappySim::nSections; k++)
+            vSection[k] = LoadI(&nSectionHeight[k][i]);
+        __m128i vRandom = LoadI(&nRandom[i]);
+        __m128i vNext = _mm_xor_si128(vRandom, _mm_slli_epi32(vRandom, 13));
+        vNext = _mm_xor_si128(vNext, _mm_srli_epi32(vNext, 17));
+        vNext = _mm_xor_si128(vNext, _mm_slli_epi32(vNext, 5));
+        vRandom = Select(vScrollI, vNext, vRandom);
+        __m128 vU = _mm_mul_ps(_mm_cvtepi32_ps(_mm_srli_epi32(vRandom, 8)), _mm_set1_ps(1.0f / 16777216.0f));
+        __m128i vNew = _mm_cvttps_epi32(_mm_mul_ps(vU, _mm_set1_ps((float)(sim.Height() - 20))));
+        vNew = _mm_andnot_si128(_mm_cmplt_epi32(vNew, _mm_set1_epi32(11)), vNew);
+        for (int k = 0; k + 1 < FlappySim::nSections; k++)
+            vSection[k] = Select(vScrollI, vSection[k + 1], vSection[k]);
+        vSection[FlappySim::nSections - 1] = Select(vScrollI, vNew, vSection[FlappySim::nSections - 1]);
+
+        // Colisão: teto e chão, depois a caixa do pássaro contra cada cano
+        __m128 vHit = _mm_or_ps(_mm_cmplt_ps(vPos, _mm_set1_ps(2.0f)),
+                                _mm_cmpgt_ps(vPos, _mm_set1_ps((float)(sim.Height() - 2))));
+        __m128i vRow0 = _mm_cvttps_epi32(vPos);
+        __m128i vRow1 = _mm_add_epi32(vRow0, _mm_set1_epi32(FlappySim::nBirdHeight));
+        __m128i vCol0 = _mm_set1_epi32(sim.BirdX());
+        __m128i vCol1 = _mm_set1_epi32(sim.BirdX() + FlappySim::nBirdWidth);
+        __m128i vHeight = _mm_set1_epi32(sim.Height());
+        for (int k = 0; k < FlappySim::nSections; k++) {
+            __m128 vBase = _mm_set1_ps(k * sim.SectionWidth());
+            __m128i vX1 = _mm_cvttps_epi32(_mm_sub_ps(_mm_add_ps(vBase, _mm_set1_ps((float)FlappySim::nPipeLeft)), vLevel));
+            __m128i vX2 = _mm_cvttps_epi32(_mm_sub_ps(_mm_add_ps(vBase, _mm_set1_ps((float)FlappySim::nPipeRight)), vLevel));
+            __m128i vBottomStart = _mm_sub_epi32(vHeight, vSection[k]);
+            __m128i vTopEnd = _mm_sub_epi32(vBottomStart, _mm_set1_epi32(FlappySim::nGapHeight));
+            __m128i vPipe = _mm_andnot_si128(_mm_cmpeq_epi32(vSection[k], vZero),
+                            _mm_and_si128(_mm_cmplt_epi32(vX1, vCol1), _mm_cmplt_epi32(vCol0, vX2)));
+            __m128i vRows = _mm_or_si128(_mm_cmplt_epi32(vRow0, vTopEnd), _mm_cmpgt_epi32(vRow1, vBottomStart));
+            vHit = _mm_or_ps(vHit, _mm_castsi128_ps(_mm_and_si128(vPipe, vRows)));
+        }
+        __m128i vHitI = _mm_castps_si128(vHit);
+
+        // Saídas, e recomeço das raias que bateram
+        StoreI(&nDone[i], _mm_and_si128(vHitI, vOne));
+        _mm_storeu_ps(&fReward[i], _mm_andnot_ps(vHit, _mm_set1_ps(1.0f)));
+        StoreI(&nLastScore[i], Select(vHitI, vFlaps, LoadI(&nLastScore[i])));
+        _mm_storeu_ps(&fBirdAcceleration[i], _mm_andnot_ps(vHit, vAcc));
+        _mm_storeu_ps(&fBirdVelocity[i], _mm_andnot_ps(vHit, vVel));
+        _mm_storeu_ps(&fBirdPosition[i], Select(vHit, _mm_set1_ps(sim.Height() / 2.0f), vPos));
+        _mm_storeu_ps(&fLevelPosition[i], vLevel);
+        for (int k = 0; k < FlappySim::nSections; k++)
+            StoreI(&nSectionHeight[k][i], _mm_andnot_si128(vHitI, vSection[k]));
+        StoreI(&nRandom[i], vRandom);
+        StoreI(&nFlapCount[i], _mm_andnot_si128(vHitI, vFlaps));
+        StoreI(&nEpisodeSteps[i], _mm_andnot_si128(vHitI, _mm_add_epi32(LoadI(&nEpisodeSteps[i]), vOne)));
+    }
+#endif
+
+    FlappySim sim;
+    int nInstances;
+    WorkerPool workers;
+};
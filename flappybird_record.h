@@ -0,0 +1,419 @@
+#pragma once
+
+// Gravação e reprodução das telas de um jogo da olcConsoleGameEngine.
+//
+// Cada frame é gravado como diferença em relação ao anterior: só as células
+// que mudaram entram no arquivo, agrupadas em sequências de células iguais
+// (RLE). O laço do jogo passa a tela e os retângulos que o desenho mudou
+// (FlappyRenderer::Dirty); só as células desses retângulos são copiadas para
+// um buffer livre. Comparar, codificar e escrever no arquivo (ou pipe) fica
+// com uma thread em segundo plano, que guarda a última tela gravada e
+// compara só os retângulos. Se a thread atrasar e os buffers acabarem, o
+// frame é descartado e contado, em vez de travar o jogo; o frame seguinte
+// copia a tela inteira, então a sequência continua válida.
+//
+// Formato (inteiros little-endian):
+//   cabeçalho: "OLCR", versão (u16), largura (u16), altura (u16), reservado (u16)
+//   cada frame: tempo em ms desde o início (u32), bytes do corpo (u32), corpo
+//   corpo: sequências de [células iguais puladas (varint), quantidade (varint),
+//          caractere (u16), atributos (u16)]; o que sobra no fim não mudou.
+
+#include <algorithm>   // sort dos trechos de linha.
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>     // Tipos inteiros de tamanho fixo (uint16_t, uint32_t).
+#include <cstdio>      // Arquivo ou pipe de saída.
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+using namespace std;
+
+#include "flappybird_render.h" // CellRect: as regiões que mudaram no frame.
+
+// Célula compactada: caractere nos 16 bits altos e atributos nos baixos.
+inline uint32_t PackCell(const CHAR_INFO& c) {
+    return (uint32_t)(uint16_t)c.Char.UnicodeChar << 16 | (uint16_t)c.Attributes;
+}
+
+inline void PutVarint(vector<uint8_t>& out, uint32_t n) {
+    while (n >= 0x80) {
+        out.push_back((uint8_t)(n | 0x80));
+        n >>= 7;
+    }
+    out.push_back((uint8_t)n);
+}
+
+inline bool GetVarint(const uint8_t*& p, const uint8_t* pEnd, uint32_t& n) {
+    n = 0;
+    for (int nShift = 0; p < pEnd && nShift < 35; nShift += 7) {
+        uint8_t b = *p++;
+        n |= (uint32_t)(b & 0x7F) << nShift;
+        if (!(b & 0x80))
+            return true;
+    }
+    return false;
+}
+
+inline void PutU16(vector<uint8_t>& out, uint32_t n) {
+    out.push_back((uint8_t)n);
+    out.push_back((uint8_t)(n >> 8));
+}
+
+inline void PutU32(vector<uint8_t>& out, uint32_t n) {
+    PutU16(out, n & 0xFFFF);
+    PutU16(out, n >> 16);
+}
+
+// Codifica as células [nBegin, nEnd) de cur como diferença em relação a
+// prev e acrescenta em out. nLastEnd é o fim da última sequência gravada no
+// frame; os trechos de um frame vêm em ordem crescente e sem sobreposição.
+inline void EncodeRangeDelta(const uint32_t* prev, const uint32_t* cur, int nBegin, int nEnd, int& nLastEnd, vector<uint8_t>& out) {
+    int i = nBegin, nCells = nEnd;
+    while (i < nCells) {
+        // Pula as células iguais 8 bytes por vez enquanto der
+        while (i + 2 <= nCells && memcmp(prev + i, cur + i, 8) == 0)
+            i += 2;
+        while (i < nCells && prev[i] == cur[i])
+            i++;
+        if (i == nCells)
+            break;
+        int nStart = i;
+        uint32_t nCell = cur[i];
+        while (i < nCells && cur[i] == nCell && prev[i] != nCell)
+            i++;
+        PutVarint(out, (uint32_t)(nStart - nLastEnd));
+        PutVarint(out, (uint32_t)(i - nStart));
+        PutU16(out, nCell >> 16);
+        PutU16(out, nCell & 0xFFFF);
+        nLastEnd = i;
+    }
+}
+
+// Codifica cur inteiro como diferença em relação a prev.
+inline void EncodeFrameDelta(const uint32_t* prev, const uint32_t* cur, int nCells, vector<uint8_t>& out) {
+    int nLastEnd = 0;
+    EncodeRangeDelta(prev, cur, 0, nCells, nLastEnd, out);
+}
+
+// Aplica em cells o corpo de um frame. Retorna false se os dados estiverem
+// corrompidos.
+inline bool DecodeFrameDelta(const uint8_t* p, const uint8_t* pEnd, uint32_t* cells, int nCells) {
+    int i = 0;
+    while (p < pEnd) {
+        uint32_t nSkip, nCount;
+        if (!GetVarint(p, pEnd, nSkip) || !GetVarint(p, pEnd, nCount) || pEnd - p < 4)
+            return false;
+        if (nSkip > (uint32_t)(nCells - i) || nCount > (uint32_t)(nCells - i) - nSkip)
+            return false;
+        uint32_t nCell = (uint32_t)(p[0] | p[1] << 8) << 16 | (uint32_t)(p[2] | p[3] << 8);
+        p += 4;
+        i += nSkip;
+        for (uint32_t k = 0; k < nCount; k++)
+            cells[i++] = nCell;
+    }
+    return true;
+}
+
+class FrameRecorder {
+public:
+    static const int nBuffers = 16; // Frames que podem esperar pela thread
+
+    FrameRecorder() = default;
+    FrameRecorder(const FrameRecorder&) = delete;
+    FrameRecorder& operator=(const FrameRecorder&) = delete;
+    ~FrameRecorder() { Close(); }
+
+    // Abre o arquivo ("-" grava na saída padrão, para mandar por um pipe) e
+    // inicia a thread de escrita. Retorna false e preenche sError se falhar.
+    bool Open(const string& sPath, int nWidth, int nHeight, string& sError) {
+        f = sPath == "-" ? stdout : fopen(sPath.c_str(), "wb");
+        if (!f) {
+            sError = "não foi possível criar " + sPath;
+            return false;
+        }
+        bOwnsFile = f != stdout;
+        this->nWidth = nWidth;
+        this->nHeight = nHeight;
+        int nCells = nWidth * nHeight;
+        pool.assign(nBuffers, Frame{ 0, {}, vector<uint32_t>(nCells) });
+        for (Frame& frame : pool)
+            frame.rects.reserve(64);
+        for (int i = 0; i < nBuffers; i++)
+            freeFrames.push_back(i);
+        tpStart = chrono::steady_clock::now();
+
+        vector<uint8_t> header = { 'O', 'L', 'C', 'R' };
+        PutU16(header, 1);
+        PutU16(header, (uint32_t)nWidth);
+        PutU16(header, (uint32_t)nHeight);
+        PutU16(header, 0);
+        fwrite(header.data(), 1, header.size(), f);
+        nFileBytes = header.size();
+
+        bQuit = false;
+        writer = thread([this] { WriterLoop(); });
+        return true;
+    }
+
+    bool IsOpen() const { return f != nullptr; }
+
+    // Chamado pelo laço do jogo depois de desenhar: copia só as células dos
+    // retângulos que mudaram desde o último Capture e volta. O primeiro frame
+    // e o seguinte a um descarte copiam a tela inteira.
+    void Capture(const CHAR_INFO* screen, const vector<CellRect>& dirty) {
+        int nIndex;
+        {
+            lock_guard<mutex> lock(mtx);
+            if (freeFrames.empty()) {
+                nDropped++;
+                bFullNext = true; // As mudanças deste frame se perderiam
+                return;
+            }
+            nIndex = freeFrames.back();
+            freeFrames.pop_back();
+        }
+        Frame& frame = pool[nIndex];
+        frame.nTimeMs = (uint32_t)chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - tpStart).count();
+        frame.rects.clear();
+        if (bFullNext) {
+            frame.rects.push_back({ 0, 0, nWidth, nHeight });
+            bFullNext = false;
+        } else {
+            for (const CellRect& r : dirty) {
+                CellRect c = ClipRect(r, nWidth, nHeight);
+                if (!c.Empty())
+                    frame.rects.push_back(c);
+            }
+        }
+        size_t nCount = 0;
+        for (const CellRect& r : frame.rects)
+            nCount += r.Cells();
+        if (nCount > (size_t)nWidth * nHeight) {
+            // Retângulos sobrepostos somando mais que a tela: copia a tela
+            // inteira, que cabe no buffer sem alocar
+            frame.rects.assign(1, { 0, 0, nWidth, nHeight });
+            nCount = (size_t)nWidth * nHeight;
+        }
+        frame.cells.resize(nCount);
+        uint32_t* p = frame.cells.data();
+        for (const CellRect& r : frame.rects)
+            for (int y = r.nY1; y < r.nY2; y++)
+                for (const CHAR_INFO* c = screen + (size_t)y * nWidth + r.nX1; c != screen + (size_t)y * nWidth + r.nX2; c++)
+                    *p++ = PackCell(*c);
+        {
+            lock_guard<mutex> lock(mtx);
+            pending.push_back(nIndex);
+        }
+        cv.notify_one();
+    }
+
+    // Grava o que falta e fecha o arquivo.
+    void Close() {
+        if (!f)
+            return;
+        {
+            lock_guard<mutex> lock(mtx);
+            bQuit = true;
+        }
+        cv.notify_one();
+        writer.join();
+        fflush(f);
+        if (bOwnsFile)
+            fclose(f);
+        f = nullptr;
+    }
+
+    // Resumo para o fim da gravação: frames, tamanho em relação à tela crua.
+    void PrintStats(FILE* out) const {
+        size_t nRaw = (size_t)nFrames * nWidth * nHeight * sizeof(CHAR_INFO);
+        fprintf(out, "%d frames gravados, %d descartados, %zu bytes (%.2f%% de %zu bytes da tela crua)\n",
+                nFrames, nDropped, nFileBytes, nRaw ? 100.0 * nFileBytes / nRaw : 0.0, nRaw);
+    }
+
+private:
+    struct Frame {
+        uint32_t nTimeMs;
+        vector<CellRect> rects;  // Regiões copiadas, na ordem do Capture
+        vector<uint32_t> cells;  // Células das regiões, linha a linha
+    };
+
+    // Trecho [nBegin, nEnd) de células de uma linha da tela
+    struct Span {
+        int nBegin, nEnd;
+        bool operator<(const Span& other) const { return nBegin < other.nBegin; }
+    };
+
+    void WriterLoop() {
+        int nCells = nWidth * nHeight;
+        vector<uint32_t> previous(nCells, 0); // Última tela gravada (o primeiro frame é diferença contra a tela vazia)
+        vector<uint32_t> current(nCells, 0);  // previous com as regiões do frame aplicadas
+        vector<Span> spans;
+        vector<uint8_t> out;
+        while (true) {
+            int nIndex;
+            {
+                unique_lock<mutex> lock(mtx);
+                cv.wait(lock, [this] { return bQuit || !pending.empty(); });
+                if (pending.empty())
+                    return; // bQuit e nada mais a gravar
+                nIndex = pending.front();
+                pending.erase(pending.begin());
+            }
+            Frame& frame = pool[nIndex];
+
+            // Aplica as regiões em current (uma região posterior sobrescreve
+            // a anterior, como na tela) e junta os trechos de linha em ordem
+            const uint32_t* p = frame.cells.data();
+            spans.clear();
+            for (const CellRect& r : frame.rects) {
+                for (int y = r.nY1; y < r.nY2; y++) {
+                    int nBegin = y * nWidth + r.nX1, nEnd = y * nWidth + r.nX2;
+                    memcpy(current.data() + nBegin, p, (nEnd - nBegin) * sizeof(uint32_t));
+                    p += nEnd - nBegin;
+                    spans.push_back({ nBegin, nEnd });
+                }
+            }
+            sort(spans.begin(), spans.end());
+            size_t nMerged = 0;
+            for (const Span& span : spans) {
+                if (nMerged > 0 && span.nBegin <= spans[nMerged - 1].nEnd)
+                    spans[nMerged - 1].nEnd = max(spans[nMerged - 1].nEnd, span.nEnd);
+                else
+                    spans[nMerged++] = span;
+            }
+            spans.resize(nMerged);
+
+            out.clear();
+            PutU32(out, frame.nTimeMs);
+            PutU32(out, 0); // Tamanho do corpo, preenchido abaixo
+            int nLastEnd = 0;
+            for (const Span& span : spans) {
+                EncodeRangeDelta(previous.data(), current.data(), span.nBegin, span.nEnd, nLastEnd, out);
+                memcpy(previous.data() + span.nBegin, current.data() + span.nBegin, (span.nEnd - span.nBegin) * sizeof(uint32_t));
+            }
+            uint32_t nBody = (uint32_t)(out.size() - 8);
+            for (int b = 0; b < 4; b++)
+                out[4 + b] = (uint8_t)(nBody >> (8 * b));
+            fwrite(out.data(), 1, out.size(), f);
+            nFileBytes += out.size();
+            nFrames++;
+            {
+                lock_guard<mutex> lock(mtx);
+                freeFrames.push_back(nIndex);
+            }
+        }
+    }
+
+    FILE* f = nullptr;
+    bool bOwnsFile = false;
+    int nWidth = 0, nHeight = 0;
+    chrono::steady_clock::time_point tpStart;
+
+    vector<Frame> pool;        // Buffers de frame reaproveitados
+    vector<int> freeFrames;    // Índices livres em pool
+    vector<int> pending;       // Índices esperando a thread, em ordem
+    mutex mtx;
+    condition_variable cv;
+    bool bQuit = false;
+    bool bFullNext = true; // Próximo Capture copia a tela inteira (só o laço do jogo usa)
+    thread writer;
+
+    // Estatísticas (nDropped é protegido por mtx; os outros são só da thread
+    // de escrita até Close())
+    int nDropped = 0;
+    int nFrames = 0;
+    size_t nFileBytes = 0;
+};
+
+// Converte um atributo do console do Windows (bits azul, verde, vermelho e
+// intensidade, para a frente e o fundo) em cores ANSI.
+inline void AppendAnsiColor(string& out, uint16_t nAttributes) {
+    static const int nAnsi[8] = { 0, 4, 2, 6, 1, 5, 3, 7 }; // BGR do console -> RGB do ANSI
+    int nFg = nAttributes & 0x0F, nBg = (nAttributes >> 4) & 0x0F;
+    out += "\x1b[" + to_string((nFg & 8 ? 90 : 30) + nAnsi[nFg & 7]) + ";" + to_string((nBg & 8 ? 100 : 40) + nAnsi[nBg & 7]) + "m";
+}
+
+inline void AppendUtf8(string& out, uint32_t c) {
+    if (c == 0)
+        c = ' ';
+    if (c < 0x80) {
+        out += (char)c;
+    } else if (c < 0x800) {
+        out += (char)(0xC0 | c >> 6);
+        out += (char)(0x80 | (c & 0x3F));
+    } else {
+        out += (char)(0xE0 | c >> 12);
+        out += (char)(0x80 | ((c >> 6) & 0x3F));
+        out += (char)(0x80 | (c & 0x3F));
+    }
+}
+
+// Reproduz uma gravação num terminal com sequências ANSI. fSpeed multiplica
+// a velocidade original; 0 mostra os frames o mais rápido possível. Só as
+// sequências de células que mudaram são reescritas a cada frame.
+inline bool PlayRecording(const string& sPath, double fSpeed, string& sError) {
+    FILE* in = sPath == "-" ? stdin : fopen(sPath.c_str(), "rb");
+    if (!in) {
+        sError = "não foi possível abrir " + sPath;
+        return false;
+    }
+    uint8_t header[12];
+    if (fread(header, 1, 12, in) != 12 || memcmp(header, "OLCR", 4) != 0 || (header[4] | header[5] << 8) != 1) {
+        sError = sPath + ": não é uma gravação OLCR versão 1";
+        if (in != stdin) fclose(in);
+        return false;
+    }
+    int nWidth = header[6] | header[7] << 8, nHeight = header[8] | header[9] << 8;
+    int nCells = nWidth * nHeight;
+    vector<uint32_t> cells(nCells, 0), shown(nCells, 0xFFFFFFFF);
+    vector<uint8_t> body;
+    string out = "\x1b[2J\x1b[?25l"; // Limpa e esconde o cursor
+    auto tpStart = chrono::steady_clock::now();
+    int nFrames = 0;
+    bool bOk = true;
+
+    uint8_t frameHeader[8];
+    while (fread(frameHeader, 1, 8, in) == 8) {
+        uint32_t nTimeMs = frameHeader[0] | frameHeader[1] << 8 | frameHeader[2] << 16 | (uint32_t)frameHeader[3] << 24;
+        uint32_t nBody = frameHeader[4] | frameHeader[5] << 8 | frameHeader[6] << 16 | (uint32_t)frameHeader[7] << 24;
+        body.resize(nBody);
+        if (fread(body.data(), 1, nBody, in) != nBody || !DecodeFrameDelta(body.data(), body.data() + nBody, cells.data(), nCells)) {
+            sError = sPath + ": frame " + to_string(nFrames) + " corrompido";
+            bOk = false;
+            break;
+        }
+        nFrames++;
+
+        // Reescreve só as células diferentes do que está no terminal
+        uint16_t nColor = 0xFFFF;
+        int nCursor = -1; // Célula onde o cursor do terminal está
+        for (int i = 0; i < nCells; i++) {
+            if (cells[i] == shown[i])
+                continue;
+            if (i != nCursor || i % nWidth == 0)
+                out += "\x1b[" + to_string(i / nWidth + 1) + ";" + to_string(i % nWidth + 1) + "H";
+            nCursor = i + 1;
+            uint16_t nAttributes = (uint16_t)(cells[i] & 0xFFFF);
+            if (nAttributes != nColor) {
+                AppendAnsiColor(out, nAttributes);
+                nColor = nAttributes;
+            }
+            AppendUtf8(out, cells[i] >> 16);
+            shown[i] = cells[i];
+        }
+
+        if (fSpeed > 0) {
+            auto tpFrame = tpStart + chrono::duration_cast<chrono::steady_clock::duration>(chrono::duration<double, milli>(nTimeMs / fSpeed));
+            this_thread::sleep_until(tpFrame);
+        }
+        fwrite(out.data(), 1, out.size(), stdout);
+        fflush(stdout);
+        out.clear();
+    }
+    printf("\x1b[0m\x1b[?25h\x1b[%d;1H", nHeight + 1);
+    if (in != stdin)
+        fclose(in);
+    return bOk;
+}
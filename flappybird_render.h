@@ -0,0 +1,171 @@
+#pragma once
+
+// Desenho do Flappy Bird direto no buffer de CHAR_INFO da tela, sem passar
+// pelo Fill e pelo Draw da engine (que escrevem célula por célula, testando
+// os limites em cada uma).
+//
+//  - FillCells preenche um retângulo linha a linha; quando a célula tem 4
+//    bytes (CHAR_INFO no Windows: WCHAR + WORD), cada instrução SSE2 grava
+//    4 células.
+//  - FlappyRenderer guarda os retângulos desenhados no frame (canos, pássaro
+//    e texto). No frame seguinte só eles são apagados, em vez da tela
+//    inteira, e a lista do frame (apagados + desenhados) vai para o
+//    FrameRecorder, que copia e compara só essas regiões.
+
+#include <cstdint>     // Tipos inteiros de tamanho fixo (uint32_t).
+#include <cstring>     // memcpy
+#include <string>
+#include <vector>
+using namespace std;
+
+#include "flappybird_sim.h" // Estado e geometria dos canos.
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define RENDER_HAS_SSE2 1
+#include <immintrin.h> // Intrínsecos SSE2.
+#else
+#define RENDER_HAS_SSE2 0
+#endif
+
+// Retângulo de células [nX1, nX2) x [nY1, nY2).
+struct CellRect {
+    int nX1, nY1, nX2, nY2;
+
+    bool Empty() const { return nX1 >= nX2 || nY1 >= nY2; }
+    int Cells() const { return Empty() ? 0 : (nX2 - nX1) * (nY2 - nY1); }
+};
+
+// Recorta o retângulo contra uma tela de nWidth x nHeight.
+inline CellRect ClipRect(CellRect r, int nWidth, int nHeight) {
+    r.nX1 = max(r.nX1, 0);
+    r.nY1 = max(r.nY1, 0);
+    r.nX2 = min(r.nX2, nWidth);
+    r.nY2 = min(r.nY2, nHeight);
+    return r;
+}
+
+inline CHAR_INFO MakeCell(wchar_t c, short nColor) {
+    CHAR_INFO cell;
+    memset(&cell, 0, sizeof(cell));
+    cell.Char.UnicodeChar = c;
+    cell.Attributes = (uint16_t)nColor;
+    return cell;
+}
+
+// Preenche uma sequência de nCount células com o mesmo valor.
+inline void FillRow(CHAR_INFO* dst, int nCount, const CHAR_INFO& cell, bool bSimd = true) {
+    int i = 0;
+#if RENDER_HAS_SSE2
+    if (bSimd && sizeof(CHAR_INFO) == 4) {
+        uint32_t nPattern;
+        memcpy(&nPattern, &cell, 4);
+        __m128i v = _mm_set1_epi32((int)nPattern);
+        for (; i + 4 <= nCount; i += 4)
+            _mm_storeu_si128((__m128i*)(dst + i), v);
+    }
+#endif
+    (void)bSimd;
+    for (; i < nCount; i++)
+        dst[i] = cell;
+}
+
+// Preenche um retângulo (recortado contra a tela).
+inline void FillCells(CHAR_INFO* screen, int nWidth, int nHeight, CellRect r, const CHAR_INFO& cell, bool bSimd = true) {
+    r = ClipRect(r, nWidth, nHeight);
+    if (r.Empty())
+        return;
+    for (int y = r.nY1; y < r.nY2; y++)
+        FillRow(screen + (size_t)y * nWidth + r.nX1, r.nX2 - r.nX1, cell, bSimd);
+}
+
+// Escreve o texto a partir de (x, y), cortando o que sair da tela.
+inline CellRect DrawText(CHAR_INFO* screen, int nWidth, int nHeight, int x, int y, const wstring& sText, short nColor = 0x000F) {
+    CellRect r = ClipRect({ x, y, x + (int)sText.size(), y + 1 }, nWidth, nHeight);
+    for (int i = r.nX1; i < r.nX2 && !r.Empty(); i++)
+        screen[(size_t)y * nWidth + i] = MakeCell(sText[i - x], nColor);
+    return r;
+}
+
+class FlappyRenderer {
+public:
+    bool bSimd = true;   // FillCells com SSE2
+    bool bDirty = true;  // Apaga só os retângulos do frame anterior
+
+    FlappyRenderer(int nWidth, int nHeight) : nWidth(nWidth), nHeight(nHeight) {}
+
+    // Desenha o estado em screen: apaga o que o frame anterior desenhou,
+    // depois os canos, o pássaro e o texto.
+    void Draw(CHAR_INFO* screen, const FlappySim& sim, const FlappyState& s, const wstring& sText) {
+        const CHAR_INFO blank = MakeCell(L' ', 0x000F);
+        const CHAR_INFO pipe = MakeCell((wchar_t)PIXEL_SOLID, FG_GREEN);
+
+        dirty.clear();
+        nCellsWritten = 0;
+        if (bFullClear || !bDirty) {
+            Fill(screen, { 0, 0, nWidth, nHeight }, blank);
+            bFullClear = false;
+        } else {
+            for (const CellRect& r : drawn)
+                Fill(screen, r, blank);
+        }
+        drawn.clear();
+
+        // Canos
+        for (int nSection = 0; nSection < s.sections.Size(); nSection++) {
+            int h = s.sections[nSection];
+            if (h == 0)
+                continue;
+            int nX1, nX2, nTopEnd, nBottomStart;
+            sim.PipeColumns(s, nSection, nX1, nX2);
+            sim.PipeRows(h, nTopEnd, nBottomStart);
+            Fill(screen, { nX1, nBottomStart, nX2, nHeight }, pipe, true);
+            Fill(screen, { nX1, 0, nX2, nTopEnd }, pipe, true);
+        }
+
+        // Pássaro: asas para cima descendo, para baixo subindo
+        int nBirdX = sim.BirdX();
+        int nRow = (int)s.fBirdPosition;
+        if (s.fBirdVelocity > 0) {
+            Text(screen, nBirdX, nRow, L"\\\\\\");
+            Text(screen, nBirdX, (int)(s.fBirdPosition + 1), L"<\\\\\\=Q");
+        } else {
+            Text(screen, nBirdX, nRow, L"<///=Q");
+            Text(screen, nBirdX, (int)(s.fBirdPosition + 1), L"///");
+        }
+
+        Text(screen, 1, 1, sText);
+    }
+
+    // Retângulos que mudaram no último Draw (apagados e desenhados).
+    const vector<CellRect>& Dirty() const { return dirty; }
+
+    // Células escritas no último Draw, para medir o tráfego de memória.
+    size_t CellsWritten() const { return nCellsWritten; }
+
+private:
+    void Fill(CHAR_INFO* screen, CellRect r, const CHAR_INFO& cell, bool bKeep = false) {
+        r = ClipRect(r, nWidth, nHeight);
+        if (r.Empty())
+            return;
+        FillCells(screen, nWidth, nHeight, r, cell, bSimd);
+        nCellsWritten += r.Cells();
+        dirty.push_back(r);
+        if (bKeep)
+            drawn.push_back(r);
+    }
+
+    void Text(CHAR_INFO* screen, int x, int y, const wstring& sText) {
+        CellRect r = DrawText(screen, nWidth, nHeight, x, y, sText);
+        if (r.Empty())
+            return;
+        nCellsWritten += r.Cells();
+        dirty.push_back(r);
+        drawn.push_back(r);
+    }
+
+    int nWidth, nHeight;
+    bool bFullClear = true;  // O primeiro Draw apaga (e marca) a tela inteira
+    vector<CellRect> drawn;  // O que este frame desenhou (apagado no próximo)
+    vector<CellRect> dirty;  // O que este frame mudou
+    size_t nCellsWritten = 0;
+};
@@ -0,0 +1,189 @@
+#pragma once
+
+// Física do Flappy Bird separada do desenho: o estado do jogo, um passo de
+// simulação com tempo fixo e a colisão calculada pela geometria dos canos
+// (caixas alinhadas aos eixos), sem ler nada do buffer da tela. O desenho
+// só consome o estado, então a simulação roda sem console.
+
+#include <cstdint>     // Tipos inteiros de tamanho fixo (uint32_t).
+#include <type_traits> // is_trivially_copyable, para garantir que o estado é POD.
+using namespace std;
+
+// Seções na tela, do mais à esquerda para o mais à direita, num buffer
+// circular de tamanho fixo: a seção nova entra no lugar da que saiu, sem
+// alocar nada.
+struct SectionRing {
+    static const int nCapacity = 4;
+
+    int nHeight[nCapacity];  // Altura do cano de baixo (0: sem cano)
+    int nFirst;              // Posição da seção mais à esquerda
+
+    void Clear() {
+        for (int& h : nHeight)
+            h = 0;
+        nFirst = 0;
+    }
+
+    int Size() const { return nCapacity; }
+
+    // k-ésima seção a partir da esquerda
+    int operator[](int k) const { return nHeight[(nFirst + k) % nCapacity]; }
+
+    // Tira a seção da esquerda e põe h na direita
+    void Push(int h) {
+        nHeight[nFirst] = h;
+        nFirst = (nFirst + 1) % nCapacity;
+    }
+};
+
+// Estado de uma partida. É um valor POD de algumas dezenas de bytes, sem
+// ponteiros: uma cópia é um snapshot e atribuir a cópia de volta restaura a
+// partida, incluindo o gerador dos canos. Algoritmos de busca podem clonar e
+// voltar estados à vontade, sem alocar memória.
+struct FlappyState {
+    float fBirdPosition;     // Posição vertical do pássaro (linha da parte de cima)
+    float fBirdVelocity;     // Velocidade do pássaro (para cima/baixo)
+    float fBirdAcceleration; // Aceleração do pássaro (afetada pela gravidade)
+    float fLevelPosition;    // Posição horizontal do nível (scroll)
+    SectionRing sections;    // Obstáculos na tela
+    uint32_t nRandom;        // Gerador xorshift32 da altura das seções novas
+    bool bHasCollided;
+    int nFlapCount;          // Batidas de asa na tentativa atual
+};
+
+static_assert(is_trivially_copyable<FlappyState>::value, "FlappyState precisa ser copiável com memcpy");
+
+// Regras do jogo para uma tela de nWidth x nHeight células. Os métodos são
+// const: o mesmo FlappySim serve para quantos estados se quiser.
+class FlappySim {
+public:
+    static constexpr float fGravity = 100.0f;     // Gravidade que afeta o pássaro
+    static constexpr float fScrollSpeed = 14.0f;  // Células por segundo que o nível anda
+    static constexpr float fTimeStep = 1.0f / 60.0f; // Segundos por passo
+    static const int nSections = SectionRing::nCapacity; // Seções na tela ao mesmo tempo
+    static const int nPipeLeft = 10;              // Coluna do cano dentro da seção
+    static const int nPipeRight = 15;             // Coluna após o fim do cano
+    static const int nGapHeight = 15;             // Altura da abertura entre os canos
+    static const int nBirdWidth = 7;              // Colunas do pássaro (até nBirdX + 6, como antes)
+    static const int nBirdHeight = 2;             // Linhas do pássaro
+
+    FlappySim(int nWidth, int nHeight)
+        : nWidth(nWidth), nHeight(nHeight),
+          fSectionWidth((float)nWidth / (float)(nSections - 1)),
+          nBirdX((int)(nWidth / 3.0f)) {}
+
+    int Width() const { return nWidth; }
+    int Height() const { return nHeight; }
+    float SectionWidth() const { return fSectionWidth; }
+    int BirdX() const { return nBirdX; }
+
+    // Começa uma partida do zero com a semente nSeed. A mesma semente e as
+    // mesmas batidas de asa geram sempre a mesma partida.
+    void Start(FlappyState& s, uint32_t nSeed) const {
+        s.fLevelPosition = 0.0f;
+        s.nRandom = Seed(nSeed);
+        Reset(s);
+    }
+
+    // Começa uma tentativa nova. O nível e o gerador continuam de onde estavam.
+    void Reset(FlappyState& s) const {
+        s.bHasCollided = false;
+        s.sections.Clear();
+        s.fBirdAcceleration = 0.0f;
+        s.fBirdVelocity = 0.0f;
+        s.fBirdPosition = nHeight / 2.0f;
+        s.nFlapCount = 0;
+    }
+
+    // Avança fTimeStep segundos. bFlap: o jogador bateu asa neste passo.
+    // Retorna true se o pássaro bateu (e, a partir daí, nada mais muda).
+    bool Step(FlappyState& s, bool bFlap) const {
+        if (s.bHasCollided)
+            return true;
+
+        if (bFlap && s.fBirdVelocity >= fGravity / 10.0f) {
+            s.fBirdAcceleration = 0.0f;
+            s.fBirdVelocity = -fGravity / 4.0f; // Bate asa (movimenta para cima)
+            s.nFlapCount++;
+        } else {
+            s.fBirdAcceleration += fGravity * fTimeStep; // Gravidade
+        }
+        if (s.fBirdAcceleration >= fGravity)
+            s.fBirdAcceleration = fGravity;
+
+        s.fBirdVelocity += s.fBirdAcceleration * fTimeStep;
+        s.fBirdPosition += s.fBirdVelocity * fTimeStep;
+        s.fLevelPosition += fScrollSpeed * fTimeStep;
+
+        // Seção nova quando o nível anda uma seção inteira
+        if (s.fLevelPosition > fSectionWidth) {
+            s.fLevelPosition -= fSectionWidth;
+            s.nRandom = NextRandom(s.nRandom);
+            s.sections.Push(SectionHeight(s.nRandom));
+        }
+
+        s.bHasCollided = Collides(s);
+        return s.bHasCollided;
+    }
+
+    // Colunas [nX1, nX2) do cano da seção nSection, já arredondadas como no
+    // desenho (que trunca as coordenadas para inteiro).
+    void PipeColumns(const FlappyState& s, int nSection, int& nX1, int& nX2) const {
+        nX1 = (int)(nSection * fSectionWidth + nPipeLeft - s.fLevelPosition);
+        nX2 = (int)(nSection * fSectionWidth + nPipeRight - s.fLevelPosition);
+    }
+
+    // Linhas ocupadas pelos canos de uma seção de altura nHeightSection: o de
+    // cima em [0, nTopEnd) e o de baixo em [nBottomStart, altura da tela).
+    void PipeRows(int nHeightSection, int& nTopEnd, int& nBottomStart) const {
+        nTopEnd = nHeight - nHeightSection - nGapHeight;
+        nBottomStart = nHeight - nHeightSection;
+    }
+
+    // Colisão com o teto, o chão ou um cano: a caixa do pássaro (nBirdWidth x
+    // nBirdHeight células a partir de nBirdX e da linha do pássaro) contra a
+    // caixa de cada cano.
+    bool Collides(const FlappyState& s) const {
+        if (s.fBirdPosition < 2 || s.fBirdPosition > nHeight - 2)
+            return true;
+        int nRow0 = (int)s.fBirdPosition;
+        int nRow1 = nRow0 + nBirdHeight;            // Linha após o pássaro
+        int nCol0 = nBirdX, nCol1 = nBirdX + nBirdWidth;
+        for (int nSection = 0; nSection < nSections; nSection++) {
+            int h = s.sections[nSection];
+            if (h != 0) {
+                int nX1, nX2, nTopEnd, nBottomStart;
+                PipeColumns(s, nSection, nX1, nX2);
+                PipeRows(h, nTopEnd, nBottomStart);
+                if (nX1 < nCol1 && nCol0 < nX2 && (nRow0 < nTopEnd || nRow1 > nBottomStart))
+                    return true;
+            }
+        }
+        return false;
+    }
+
+    // Estado inicial do gerador para uma semente (nunca zero, que é ponto
+    // fixo do xorshift)
+    static uint32_t Seed(uint32_t nSeed) { return nSeed * 2654435761u | 1u; }
+
+    static uint32_t NextRandom(uint32_t x) {
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        return x;
+    }
+
+    // Altura de uma seção nova a partir de 24 bits aleatórios, entre 0 e
+    // altura - 21; seções baixas demais ficam sem cano.
+    int SectionHeight(uint32_t r) const {
+        float u = (float)(int32_t)(r >> 8) * (1.0f / 16777216.0f);
+        int h = (int)(u * (float)(nHeight - 20));
+        return h <= 10 ? 0 : h;
+    }
+
+private:
+    int nWidth;
+    int nHeight;
+    float fSectionWidth;
+    int nBirdX;
+};
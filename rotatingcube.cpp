@@ -1,163 +1,598 @@
 #include <SDL2/SDL.h>
 #include <vector>
 #include <cmath>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
 
-// Classe responsável por gerenciar a tela, renderização e entrada do usuário
+#include "rotatingcube_raster.h" // Framebuffer na CPU e rasterização de linhas
+#include "rotatingcube_mesh.h"   // Malha em SoA, matriz de rotação e leitura de OBJ/PLY
+#include "rotatingcube_fill.h"   // Triângulos preenchidos com z-buffer, em blocos e threads
+#include "rotatingcube_scene.h"  // Câmera em perspectiva e descarte antes de rasterizar
+#include "rotatingcube_stats.h"  // Percentis dos tempos de frame
+#include "rotatingcube_timing.h" // Passo fixo e espera entre frames
+
+// Classe responsável por gerenciar a tela, renderização e entrada do usuário.
+// Sem janela (headless), o SDL nem é inicializado: o frame fica só no
+// Framebuffer, que é desenhado inteiro na CPU, e show() e input() não fazem
+// nada. Assim roda em máquinas sem vídeo.
 class Screen{
     SDL_Event e; // Evento para capturar a entrada do usuário
-    SDL_Window* window; // Janela SDL
-    SDL_Renderer* renderer; // Renderizador SDL
-    std::vector<SDL_FPoint> points; // Vetor de pontos para desenhar na tela
+    SDL_Window* window = nullptr; // Janela SDL
+    SDL_Renderer* renderer = nullptr; // Renderizador SDL
+    SDL_Texture* texture = nullptr; // Textura que recebe o framebuffer a cada frame
+    Framebuffer framebuffer{640, 480}; // Pixels do frame, desenhados na CPU
+    bool headless; // Sem janela
 
 public:
-    // Construtor que inicializa a janela e o renderizador
-    Screen(){
+    static const uint32_t white = 0xFFFFFFFF; // Cor dos pontos e linhas
+    static const uint32_t black = 0xFF000000; // Cor de fundo
+
+    // Construtor que inicializa a janela, o renderizador e a textura. Com
+    // vsync, SDL_RenderPresent espera o retraço do monitor.
+    explicit Screen(bool headless = false, bool vsync = false) : headless(headless){
+        framebuffer.clear(black);
+        if(headless)
+            return;
         SDL_Init(SDL_INIT_VIDEO); // Inicializa o subsistema de vídeo do SDL
-        SDL_CreateWindowAndRenderer(640*2,480*2,0,&window,&renderer); // Cria uma janela de 1280x960
-        SDL_RenderSetScale(renderer,2,2); // Ajusta a escala de renderização para 2x
+        // Cria uma janela de 1280x960
+        window = SDL_CreateWindow("rotatingcube", SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, 640*2, 480*2, 0);
+        renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED | (vsync ? SDL_RENDERER_PRESENTVSYNC : 0));
+        // Textura de 640x480 esticada para a janela (a escala 2x de antes)
+        texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STREAMING,
+                                    framebuffer.width, framebuffer.height);
+    }
+
+    ~Screen(){
+        if(headless)
+            return;
+        SDL_DestroyTexture(texture);
+        SDL_DestroyRenderer(renderer);
+        SDL_DestroyWindow(window);
+        SDL_Quit();
     }
 
-    // Função para adicionar um ponto a ser desenhado
+    // Função para desenhar um ponto
     void pixel(float x,float y){
-        points.emplace_back(x,y); // Adiciona o ponto ao vetor de pontos
+        framebuffer.pixel((int)std::lround(x), (int)std::lround(y), white);
     }
 
-    // Função para mostrar os pontos na tela
-    void show(){
-        SDL_SetRenderDrawColor(renderer,0,0,0,255); // Define a cor de fundo (preto)
-        SDL_RenderClear(renderer); // Limpa a tela
+    // Função para desenhar uma linha, recortada contra a tela
+    void line(float x1, float y1, float x2, float y2){
+        framebuffer.line(x1, y1, x2, y2, white);
+    }
 
-        SDL_SetRenderDrawColor(renderer,255,255,255,255); // Define a cor de renderização (branco)
-        for(auto& point : points){
-            SDL_RenderDrawPointF(renderer,point.x, point.y); // Desenha cada ponto na tela
+    // Função para mostrar o frame na tela: uma cópia para a textura e uma
+    // chamada de desenho, qualquer que seja a quantidade de pontos
+    void show(){
+        if(headless)
+            return;
+        void* dst;
+        int pitch;
+        if(SDL_LockTexture(texture, nullptr, &dst, &pitch) == 0){
+            for(int y = 0; y < framebuffer.height; y++){
+                std::memcpy((char*)dst + (size_t)y * pitch, &framebuffer.pixels[(size_t)y * framebuffer.width],
+                            framebuffer.width * sizeof(uint32_t));
+            }
+            SDL_UnlockTexture(texture);
         }
+        SDL_RenderCopy(renderer, texture, nullptr, nullptr);
         SDL_RenderPresent(renderer); // Atualiza a tela
     }
 
-    // Função para limpar o vetor de pontos
+    // Framebuffer do frame, para quem desenha direto nos pixels
+    Framebuffer& frame(){
+        return framebuffer;
+    }
+
+    // Função para limpar o frame
     void clear(){
-        points.clear(); // Limpa todos os pontos desenhados
+        framebuffer.clear(black);
     }
 
-    // Função para capturar eventos de entrada do usuário
-    void input(){
+    // Função para capturar eventos de entrada do usuário. Retorna false se
+    // a janela foi fechada, para o loop terminar e mostrar as estatísticas.
+    bool input(){
+        if(headless)
+            return true;
         while(SDL_PollEvent(&e)){
-            if(e.type == SDL_QUIT){
-                SDL_Quit(); // Fecha a janela se o evento de sair for detectado
-                exit(0); // Termina o programa
-            }
+            if(e.type == SDL_QUIT)
+                return false;
         }
+        return true;
     }
 };
 
-// Estrutura que representa um ponto tridimensional
-struct vec3{
-    float x,y,z;
-};
-
-// Estrutura que representa uma conexão entre dois pontos
-struct connection{
-    int a,b; // Índices dos dois pontos conectados
-};
-
-// Função para rotacionar um ponto em torno dos eixos X, Y e Z
+// Função para rotacionar um ponto em torno dos eixos X, Y e Z. Calcula os
+// senos e cossenos a cada chamada; o loop principal usa uma matriz por frame
+// (mat3::rotation) e esta função fica como referência.
 void rotate(vec3& point, float x = 1, float y= 1, float z = 1){
     float rad = 0;
+    float px, py, pz;
 
     // Rotação em torno do eixo X
     rad = x;
-    point.y = std::cos(rad) * point.y - std::sin(rad) * point.z;
-    point.z = std::sin(rad) * point.y + std::cos(rad) * point.z;
+    py = point.y; pz = point.z;
+    point.y = std::cos(rad) * py - std::sin(rad) * pz;
+    point.z = std::sin(rad) * py + std::cos(rad) * pz;
 
     // Rotação em torno do eixo Y
     rad = y;
-    point.x = std::cos(rad) * point.x - std::sin(rad) * point.z;
-    point.z = std::sin(rad) * point.x + std::cos(rad) * point.z;
+    px = point.x; pz = point.z;
+    point.x = std::cos(rad) * px - std::sin(rad) * pz;
+    point.z = std::sin(rad) * px + std::cos(rad) * pz;
 
     // Rotação em torno do eixo Z
     rad = z;
-    point.y = std::cos(rad) * point.x- std::sin(rad) * point.y;
-    point.x = std::sin(rad) * point.x + std::cos(rad) * point.y;
+    px = point.x; py = point.y;
+    point.x = std::cos(rad) * px - std::sin(rad) * py;
+    point.y = std::sin(rad) * px + std::cos(rad) * py;
 }
 
 // Função para desenhar uma linha de um ponto a outro
 void line(Screen& screen, float x1, float y1, float x2, float y2){
+    screen.line(x1, y1, x2, y2);
+}
+
+// Linha do jeito antigo: um ponto por unidade de comprimento, com seno e
+// cosseno a cada ponto, guardado num vetor. Só usada para comparação.
+void lineWithPoints(std::vector<SDL_FPoint>& points, float x1, float y1, float x2, float y2){
     float dx = x2 - x1;
     float dy = y2 - y1;
+    float length = std::sqrt(dx * dx + dy * dy);
+    float angle = std::atan2(dy,dx);
+    for(float i = 0; i < length; i++){
+        points.push_back({x1 + std::cos(angle) * i, y1 + std::sin(angle) * i});
+    }
+}
 
-    float length = std::sqrt(dx * dx + dy * dy); // Calcula o comprimento da linha
-    float angle = std::atan2(dy,dx); // Calcula o ângulo da linha
+// Mede, sem abrir janela, o tempo para desenhar malhas com muitas arestas:
+// pelo Framebuffer (recorte + Bresenham) e pelo caminho antigo com pontos.
+// Parte das linhas sai da tela, para exercitar o recorte.
+void benchLines(){
+    Framebuffer framebuffer(640, 480);
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<float> coord(-200.0f, 840.0f);
+    const int frames = 20;
 
-    // Desenha a linha pixel a pixel
-    for(float i = 0; i < length; i++){
-        screen.pixel(x1 + std::cos(angle) * i, y1 + std::sin(angle) * i);
+    std::printf("%10s %14s %14s %14s\n", "arestas", "pontos ms", "bresenham ms", "Marestas/s");
+    for(int edges : {1000, 10000, 50000}){
+        std::vector<float> ends(edges * 4);
+        for(auto& v : ends)
+            v = coord(rng);
+
+        std::vector<SDL_FPoint> points;
+        auto tp1 = std::chrono::steady_clock::now();
+        for(int f = 0; f < frames; f++){
+            points.clear();
+            for(int i = 0; i < edges; i++)
+                lineWithPoints(points, ends[4*i], ends[4*i+1], ends[4*i+2], ends[4*i+3]);
+        }
+        auto tp2 = std::chrono::steady_clock::now();
+        for(int f = 0; f < frames; f++){
+            framebuffer.clear(Screen::black);
+            for(int i = 0; i < edges; i++)
+                framebuffer.line(ends[4*i], ends[4*i+1], ends[4*i+2], ends[4*i+3], Screen::white);
+        }
+        auto tp3 = std::chrono::steady_clock::now();
+
+        double pointsMs = std::chrono::duration<double, std::milli>(tp2 - tp1).count() / frames;
+        double rasterMs = std::chrono::duration<double, std::milli>(tp3 - tp2).count() / frames;
+        std::printf("%10d %14.3f %14.3f %14.2f\n", edges, pointsMs, rasterMs, edges / rasterMs / 1000.0);
     }
 }
 
-int main(){
-    Screen screen; // Instancia a tela
+// Malha de teste em forma de esfera (grade de latitude x longitude) com
+// "rings" x "segments" vértices e as arestas da grade.
+mesh makeSphere(int rings, int segments, float radius){
+    std::vector<vec3> points;
+    std::vector<connection> edges;
+    std::vector<triangle> faces;
+    for(int r = 0; r < rings; r++){
+        float phi = 3.14159265f * (r + 0.5f) / rings;
+        for(int s = 0; s < segments; s++){
+            float theta = 2 * 3.14159265f * s / segments;
+            points.push_back({radius * std::sin(phi) * std::cos(theta), radius * std::cos(phi), radius * std::sin(phi) * std::sin(theta)});
+            int i = r * segments + s;
+            int right = r * segments + (s + 1) % segments;
+            edges.push_back({i, right});
+            if(r + 1 < rings){
+                edges.push_back({i, i + segments});
+                // Quadrado da grade em dois triângulos, voltados para fora
+                faces.push_back({i, right, i + segments});
+                faces.push_back({right, right + segments, i + segments});
+            }
+        }
+    }
+    mesh m;
+    m.assign(points, edges, faces);
+    return m;
+}
 
-    // Vetor de pontos tridimensionais (um cubo)
-    std::vector<vec3> points {
-        {100,100,100},
-        {200,100,100},
-        {200,200,100},
-        {100,200,100},
+// Mede vértices por segundo do rotate() por vértice (senos e cossenos a cada
+// vértice) e do transform por matriz, escalar e SIMD, sem abrir janela. Usa
+// o modelo passado ou uma esfera de 1M de vértices.
+void benchTransform(const std::string& path){
+    mesh m;
+    if(path.empty()){
+        m = makeSphere(1000, 1000, 200);
+    }
+    else{
+        std::string error;
+        auto tp1 = std::chrono::steady_clock::now();
+        if(!loadMesh(path, m, error)){
+            std::fprintf(stderr, "%s\n", error.c_str());
+            return;
+        }
+        auto tp2 = std::chrono::steady_clock::now();
+        std::printf("%s: leitura em %.1f ms\n", path.c_str(), std::chrono::duration<double, std::milli>(tp2 - tp1).count());
+    }
+    std::printf("%zu vértices, %zu arestas\n", m.rest.size(), m.connections.size());
 
-        {100,100,200},
-        {200,100,200},
-        {200,200,200},
-        {100,200,200}
+    const int frames = 20;
+    size_t n = m.rest.size();
+    vertexArray out;
+    auto timeFrames = [&](auto&& fn){
+        auto tp1 = std::chrono::steady_clock::now();
+        for(int f = 0; f < frames; f++)
+            fn(f);
+        auto tp2 = std::chrono::steady_clock::now();
+        return std::chrono::duration<double>(tp2 - tp1).count() / frames;
     };
 
-    // Vetor de conexões entre os pontos para formar arestas
-    std::vector<connection> connections{
-        {0,4}, {1,5}, {2,6}, {3,7}, // Conexões verticais
-        {0,1}, {1,2}, {2,3}, {3,0}, // Conexões da face frontal
-        {4,5}, {5,6}, {6,7}, {7,4}  // Conexões da face traseira
-    }; 
+    std::vector<vec3> points(n);
+    double rotateSec = timeFrames([&](int f){
+        for(size_t i = 0; i < n; i++){
+            points[i] = {m.rest.x[i], m.rest.y[i], m.rest.z[i]};
+            rotate(points[i], 0.002f * f, 0.001f * f, 0.004f * f);
+        }
+    });
+    double scalarSec = timeFrames([&](int f){
+        transformScalar(mat3::rotation(0.002f * f, 0.001f * f, 0.004f * f), m.rest, m.center, out);
+    });
+    double simdSec = timeFrames([&](int f){
+        transform(mat3::rotation(0.002f * f, 0.001f * f, 0.004f * f), m.rest, m.center, out);
+    });
+
+    std::printf("%-18s %12s %12s\n", "transform", "ms/frame", "Mvért/s");
+    std::printf("%-18s %12.3f %12.1f\n", "rotate() por ponto", rotateSec * 1000, n / rotateSec / 1e6);
+    std::printf("%-18s %12.3f %12.1f\n", "matriz escalar", scalarSec * 1000, n / scalarSec / 1e6);
+    std::printf("%-18s %12.3f %12.1f\n", "matriz SIMD", simdSec * 1000, n / simdSec / 1e6);
+}
+
+// Mede triângulos por segundo do renderizador de faces preenchidas com 1, 2,
+// 4, ... threads, numa esfera de 500k triângulos ou no modelo passado, sem
+// abrir janela. Mostra também o ganho sobre uma thread.
+void benchFill(const std::string& path){
+    mesh m;
+    if(path.empty()){
+        m = makeSphere(500, 500, 200);
+        m.center = {320, 240, 0};
+    }
+    else{
+        std::string error;
+        if(!loadMesh(path, m, error)){
+            std::fprintf(stderr, "%s\n", error.c_str());
+            return;
+        }
+        m.fit({320, 240, 0}, 200);
+    }
+    std::printf("%zu triângulos, tela 640x480\n", m.faces.size());
+
+    Framebuffer framebuffer(640, 480);
+    vertexArray points;
+    const int frames = 20;
+    int maxThreads = std::max(1, (int)std::thread::hardware_concurrency());
+    std::vector<int> counts;
+    for(int t = 1; t < maxThreads; t *= 2)
+        counts.push_back(t);
+    counts.push_back(maxThreads);
+    if(maxThreads < 4){
+        // Máquina com poucos núcleos: mede também com mais threads que núcleos
+        counts.push_back(4);
+    }
+
+    std::printf("%8s %12s %12s %10s\n", "threads", "ms/frame", "Mtri/s", "ganho");
+    double baseMs = 0;
+    for(int threads : counts){
+        triangleRenderer renderer(threads);
+        auto tp1 = std::chrono::steady_clock::now();
+        for(int f = 0; f < frames; f++){
+            transform(mat3::rotation(0.02f * f, 0.01f * f, 0.04f * f), m.rest, m.center, points);
+            framebuffer.clear(Screen::black);
+            renderer.draw(points, m.faces, framebuffer);
+        }
+        auto tp2 = std::chrono::steady_clock::now();
+        double ms = std::chrono::duration<double, std::milli>(tp2 - tp1).count() / frames;
+        if(baseMs == 0)
+            baseMs = ms;
+        std::printf("%8d %12.3f %12.2f %9.2fx\n", threads, ms, m.faces.size() / ms / 1000.0, baseMs / ms);
+    }
+}
+
+// Cena de teste: grid x grid cópias da malha no plano y = 240, do centro da
+// tela para o fundo, cada uma girando com uma fase diferente. Boa parte fica
+// fora da tela, para o descarte por tronco de visão ter o que descartar.
+std::vector<sceneObject> makeGrid(const mesh& model, int grid){
+    std::vector<sceneObject> objects;
+    float spacing = std::max(model.radius, 1.0f) * 2.5f;
+    for(int row = 0; row < grid; row++){
+        for(int col = 0; col < grid; col++){
+            sceneObject object;
+            object.model = &model;
+            object.position = {320 + (col - (grid - 1) / 2.0f) * spacing, 240, model.radius + row * spacing};
+            object.angles = {0.3f * col, 0.7f * row, 0.1f * (col + row)};
+            objects.push_back(object);
+        }
+    }
+    return objects;
+}
+
+// Mede, sem abrir janela, o desenho em arame de uma cena grande com e sem o
+// estágio de descarte (tronco de visão, arestas de costas e corte no plano
+// perto), e quantos objetos e arestas chegam ao line() em cada caso.
+void benchCull(const std::string& path){
+    mesh m;
+    if(path.empty()){
+        m = makeSphere(24, 24, 60);
+    }
+    else{
+        std::string error;
+        if(!loadMesh(path, m, error)){
+            std::fprintf(stderr, "%s\n", error.c_str());
+            return;
+        }
+        m.fit({0, 0, 0}, 60);
+    }
+
+    Framebuffer framebuffer(640, 480);
+    camera cam = camera::screenCamera(framebuffer.width, framebuffer.height);
+    sceneRenderer scene;
+    const int frames = 20;
+
+    std::printf("%zu arestas por objeto\n", m.connections.size());
+    std::printf("%8s %8s %10s %12s %12s %12s\n", "grade", "descarte", "objetos", "arestas", "desenhadas", "ms/frame");
+    for(int grid : {8, 32, 64}){
+        std::vector<sceneObject> objects = makeGrid(m, grid);
+        for(bool culling : {false, true}){
+            scene.culling = culling;
+            auto tp1 = std::chrono::steady_clock::now();
+            for(int f = 0; f < frames; f++){
+                for(auto& object : objects)
+                    object.angles.y += 0.01f;
+                framebuffer.clear(Screen::black);
+                scene.drawEdges(cam, objects, framebuffer, Screen::white);
+            }
+            auto tp2 = std::chrono::steady_clock::now();
+            double ms = std::chrono::duration<double, std::milli>(tp2 - tp1).count() / frames;
+            std::printf("%8d %8s %10d %12zu %12zu %12.3f\n", grid, culling ? "sim" : "não",
+                        scene.stats.visibleObjects, scene.stats.edges, scene.stats.drawnEdges, ms);
+        }
+    }
+}
+
+int main(int argc, char* argv[]){
+    std::string modelPath; // Modelo OBJ/PLY (vazio desenha o cubo)
+    bool fill = false;     // Desenha faces preenchidas em vez de arestas
+    int threads = std::max(1, (int)std::thread::hardware_concurrency()); // Threads do preenchimento
+    int grid = 0;          // Desenha grid x grid cópias da malha (0: uma só)
+    bool culling = true;   // Descarta o que não aparece antes de rasterizar
+    bool headless = false; // Sem janela: desenha só no Framebuffer, o mais rápido possível
+    int frames = -1;       // Frames a desenhar (0: sem fim; -1: 300 sem janela, sem fim com)
+    std::string dumpPrefix; // Grava cada frame em <prefixo>NNNNN.ppm
+    paceMode pace = paceMode::target; // Espera entre frames
+    double targetFps = 60; // FPS do modo target (e do relógio virtual sem janela)
+    for(int i = 1; i < argc; i++){
+        std::string arg = argv[i];
+        if(arg == "--bench-lines"){
+            benchLines();
+            return 0;
+        }
+        else if(arg == "--bench-transform"){
+            benchTransform(i + 1 < argc ? argv[i + 1] : "");
+            return 0;
+        }
+        else if(arg == "--bench-fill"){
+            benchFill(i + 1 < argc ? argv[i + 1] : "");
+            return 0;
+        }
+        else if(arg == "--bench-cull"){
+            benchCull(i + 1 < argc ? argv[i + 1] : "");
+            return 0;
+        }
+        else if(arg == "--fill"){
+            fill = true;
+        }
+        else if(arg == "--grid" && i + 1 < argc){
+            grid = std::max(0, std::atoi(argv[++i]));
+        }
+        else if(arg == "--no-cull"){
+            culling = false;
+        }
+        else if(arg == "--headless"){
+            headless = true;
+        }
+        else if(arg == "--frames" && i + 1 < argc){
+            frames = std::max(0, std::atoi(argv[++i]));
+        }
+        else if(arg == "--dump" && i + 1 < argc){
+            dumpPrefix = argv[++i];
+        }
+        else if(arg == "--pace" && i + 1 < argc){
+            std::string mode = argv[++i];
+            if(mode == "uncapped") pace = paceMode::uncapped;
+            else if(mode == "target") pace = paceMode::target;
+            else if(mode == "vsync") pace = paceMode::vsync;
+            else{
+                std::fprintf(stderr, "--pace: use uncapped, target ou vsync\n");
+                return 1;
+            }
+        }
+        else if(arg == "--fps" && i + 1 < argc){
+            targetFps = std::max(1.0, std::atof(argv[++i]));
+            pace = paceMode::target;
+        }
+        else if(arg == "--threads" && i + 1 < argc){
+            threads = std::atoi(argv[++i]);
+        }
+        else{
+            modelPath = arg;
+        }
+    }
+
+    // Malha desenhada: o cubo ou o modelo lido, ajustado ao centro da tela
+    mesh model;
+    if(modelPath.empty()){
+        // Vetor de pontos tridimensionais (um cubo)
+        std::vector<vec3> points {
+            {100,100,100},
+            {200,100,100},
+            {200,200,100},
+            {100,200,100},
+
+            {100,100,200},
+            {200,100,200},
+            {200,200,200},
+            {100,200,200}
+        };
+
+        // Vetor de conexões entre os pontos para formar arestas
+        std::vector<connection> connections{
+            {0,4}, {1,5}, {2,6}, {3,7}, // Conexões verticais
+            {0,1}, {1,2}, {2,3}, {3,0}, // Conexões da face frontal
+            {4,5}, {5,6}, {6,7}, {7,4}  // Conexões da face traseira
+        };
+
+        // Faces do cubo, duas por lado, no sentido anti-horário vistas de fora
+        std::vector<triangle> faces{
+            {0,3,2}, {0,2,1}, // Frente (z = 100)
+            {4,5,6}, {4,6,7}, // Trás (z = 200)
+            {0,1,5}, {0,5,4}, // Cima (y = 100)
+            {3,7,6}, {3,6,2}, // Baixo (y = 200)
+            {0,4,7}, {0,7,3}, // Esquerda (x = 100)
+            {1,2,6}, {1,6,5}  // Direita (x = 200)
+        };
+
+        // A pose de repouso fica centrada no centro de massa dos pontos
+        model.assign(points, connections, faces);
+    }
+    else{
+        std::string error;
+        if(!loadMesh(modelPath, model, error)){
+            std::fprintf(stderr, "%s\n", error.c_str());
+            return 1;
+        }
+        model.fit({320, 240, 0}, 200);
+    }
 
-    // Calcula o centro de massa dos pontos
-    vec3 c{0,0,0};
-    for(auto& p : points){
-        c.x += p.x;
-        c.y += p.y;
-        c.z += p.z;
+    // Objetos da cena: a malha no seu centro ou uma grade de cópias
+    std::vector<sceneObject> objects;
+    if(grid > 0){
+        objects = makeGrid(model, grid);
     }
-    c.x /= points.size();
-    c.y /= points.size();
-    c.z /= points.size();
+    else{
+        sceneObject object;
+        object.model = &model;
+        object.position = model.center;
+        objects.push_back(object);
+    }
+
+    if(frames < 0)
+        frames = headless ? 300 : 0;
+
+    Screen screen(headless, pace == paceMode::vsync); // Instancia a tela
+    triangleRenderer renderer(threads); // Threads do modo --fill
+    camera cam = camera::screenCamera(screen.frame().width, screen.frame().height);
+    sceneRenderer scene; // Descarte e projeção em perspectiva
+    scene.culling = culling;
+
+    frameStats stats; // Tempo de desenho de cada frame, sem a cópia para a tela
+    frameStats intervals; // Tempo entre o fim de um frame e o do seguinte
+    size_t primitives = 0; // Arestas ou triângulos enviados, para a vazão
+
+    // A rotação é simulada em passos fixos de 1/120 s, com velocidades em
+    // radianos por segundo (os incrementos antigos a cerca de 30 FPS). Cada
+    // frame desenha a interpolação entre os dois últimos passos.
+    const vec3 spin{0.06f, 0.03f, 0.12f};
+    fixedTimestep timestep(1.0 / 120);
+    framePacer pacer(pace, targetFps);
+    std::vector<vec3> previous(objects.size()), current(objects.size());
+    for(size_t i = 0; i < objects.size(); i++)
+        previous[i] = current[i] = objects[i].angles;
+    auto lastFrame = std::chrono::steady_clock::now();
 
     // Loop principal de renderização
-    while(true){
-        // Rotaciona cada ponto em torno do centro
-        for(auto& p : points){
-            p.x -= c.x;
-            p.y -= c.y;
-            p.z -= c.z;
-            rotate(p, 0.002, 0.001, 0.004);
-            p.x += c.x;
-            p.y += c.y;
-            p.z += c.z;
+    for(int frame = 0; frames == 0 || frame < frames; frame++){
+        // Sem janela o relógio é virtual (1/fps por frame), para que os
+        // frames e o hash final sejam os mesmos em qualquer máquina
+        auto now = std::chrono::steady_clock::now();
+        double elapsed = headless ? 1.0 / targetFps : std::chrono::duration<double>(now - lastFrame).count();
+        if(frame > 0)
+            intervals.add(std::chrono::duration<double, std::milli>(now - lastFrame).count());
+        lastFrame = now;
+
+        for(int step = timestep.advance(elapsed); step > 0; step--){
+            for(size_t i = 0; i < objects.size(); i++){
+                previous[i] = current[i];
+                current[i].x += spin.x * (float)timestep.step;
+                current[i].y += spin.y * (float)timestep.step;
+                current[i].z += spin.z * (float)timestep.step;
+            }
+        }
+
+        auto tp1 = std::chrono::steady_clock::now();
+        // Uma matriz por objeto e por frame aplicada à pose de repouso, que
+        // nunca é alterada
+        float alpha = (float)timestep.alpha();
+        for(size_t i = 0; i < objects.size(); i++){
+            objects[i].angles.x = previous[i].x + (current[i].x - previous[i].x) * alpha;
+            objects[i].angles.y = previous[i].y + (current[i].y - previous[i].y) * alpha;
+            objects[i].angles.z = previous[i].z + (current[i].z - previous[i].z) * alpha;
         }
 
-        // Desenha cada ponto
-        for(auto& p : points){
-            screen.pixel(p.x, p.y);
+        if(fill){
+            // Faces preenchidas, com z-buffer
+            scene.drawFaces(cam, objects, screen.frame(), renderer);
         }
+        else{
+            // Arestas visíveis; os vértices aparecem nas pontas das linhas
+            scene.drawEdges(cam, objects, screen.frame(), Screen::white);
+        }
+        auto tp2 = std::chrono::steady_clock::now();
+        stats.add(std::chrono::duration<double, std::milli>(tp2 - tp1).count());
+        primitives += fill ? scene.stats.triangles : scene.stats.drawnEdges;
 
-        // Desenha as linhas entre os pontos conectados
-        for(auto& conn : connections){
-            line(screen, points[conn.a].x, points[conn.a].y, points[conn.b].x, points[conn.b].y);
+        if(!dumpPrefix.empty()){
+            char name[32];
+            std::snprintf(name, sizeof(name), "%05d.ppm", frame);
+            if(!screen.frame().savePPM(dumpPrefix + name)){
+                std::fprintf(stderr, "não foi possível gravar %s%s\n", dumpPrefix.c_str(), name);
+                return 1;
+            }
         }
+        if(frame + 1 == frames)
+            std::printf("hash do último frame: %016llx\n", (unsigned long long)screen.frame().hash());
 
         // Mostra o resultado na tela, limpa e processa a entrada do usuário
         screen.show();
         screen.clear();
-        screen.input();
+        if(!screen.input())
+            break;
 
-        SDL_Delay(30); // Pequeno atraso para limitar a taxa de frames
+        if(!headless)
+            pacer.wait(); // Completa o período do modo target
     }
 
+    stats.print(fill ? "faces" : "arestas");
+    if(!headless && !intervals.ms.empty()){
+        intervals.print("intervalo");
+        std::printf("jitter (desvio padrão do intervalo): %.3f ms\n", intervals.stddev());
+    }
+    double totalSec = stats.total() / 1000;
+    if(totalSec > 0)
+        std::printf("%.2f M%s/s\n", primitives / totalSec / 1e6, fill ? "triângulos" : "arestas");
     return 0;
 }
@@ -0,0 +1,315 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "rotatingcube_mesh.h"   // vertexArray e triangle
+#include "rotatingcube_raster.h" // Framebuffer
+
+// Conjunto persistente de threads. run(count, fn) chama fn(i, thread) para
+// i em [0, count), com as threads pegando o próximo índice de um contador
+// atômico, e só retorna quando todos terminaram. A thread que chama também
+// trabalha, então são criadas threads - 1 threads.
+class threadPool{
+public:
+    explicit threadPool(int threads){
+        threads = std::max(threads, 1);
+        for(int i = 1; i < threads; i++)
+            workers.emplace_back([this, i]{ loop(i); });
+    }
+
+    ~threadPool(){
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            quit = true;
+        }
+        cvStart.notify_all();
+        for(auto& t : workers)
+            t.join();
+    }
+
+    threadPool(const threadPool&) = delete;
+    threadPool& operator=(const threadPool&) = delete;
+
+    int size() const { return (int)workers.size() + 1; }
+
+    void run(int count, const std::function<void(int, int)>& fn){
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            job = &fn;
+            jobCount = count;
+            next.store(0, std::memory_order_relaxed);
+            pending = (int)workers.size();
+            generation++;
+        }
+        cvStart.notify_all();
+        work(0);
+
+        std::unique_lock<std::mutex> lock(mtx);
+        cvDone.wait(lock, [this]{ return pending == 0; });
+        job = nullptr;
+    }
+
+private:
+    void work(int thread){
+        int i;
+        while((i = next.fetch_add(1, std::memory_order_relaxed)) < jobCount)
+            (*job)(i, thread);
+    }
+
+    void loop(int thread){
+        unsigned seen = 0;
+        while(true){
+            {
+                std::unique_lock<std::mutex> lock(mtx);
+                cvStart.wait(lock, [&]{ return quit || generation != seen; });
+                if(quit)
+                    return;
+                seen = generation;
+            }
+            work(thread);
+            {
+                std::lock_guard<std::mutex> lock(mtx);
+                pending--;
+            }
+            cvDone.notify_one();
+        }
+    }
+
+    std::vector<std::thread> workers;
+    std::mutex mtx;
+    std::condition_variable cvStart, cvDone;
+    const std::function<void(int, int)>* job = nullptr;
+    int jobCount = 0;
+    std::atomic<int> next{0};
+    int pending = 0;
+    unsigned generation = 0;
+    bool quit = false;
+};
+
+// Desenha triângulos preenchidos com sombreamento plano e z-buffer. A tela é
+// dividida em blocos de tileSize x tileSize pixels. Cada frame tem duas fases
+// em paralelo:
+//  1. preparo: cada thread pega um trecho dos triângulos, descarta os de
+//     costas e os fora da tela, calcula as funções de aresta, o plano de
+//     profundidade e a cor, e coloca o índice nos blocos que a caixa do
+//     triângulo cobre (uma lista por thread e por bloco, sem travas);
+//  2. rasterização: cada thread pega um bloco, ordena os triângulos dele da
+//     frente para trás e os desenha. Com a ordem da frente para trás, o teste
+//     de profundidade rejeita cedo os pixels escondidos, antes de escrever cor.
+// Blocos diferentes não compartilham pixels, então não há escrita concorrente.
+// A imagem não depende do número de threads: a ordem de cada bloco é total
+// (profundidade e depois índice) e a regra topo-esquerda dá cada pixel sobre
+// uma aresta comum a um só dos dois triângulos.
+class triangleRenderer{
+public:
+    static const int tileSize = 32;
+    static const int setupChunk = 1024; // Triângulos por tarefa de preparo
+
+    explicit triangleRenderer(int threads) : pool(threads) {}
+
+    int threads() const { return pool.size(); }
+
+    // Desenha as faces com os vértices já na posição da tela: x, y em pixels
+    // e z uma profundidade que cresce para dentro da tela e varia linearmente
+    // ao longo da tela (o z na projeção ortográfica; em perspectiva, uma
+    // função de 1/z, já que o z da câmera não é linear depois da divisão).
+    // lightPoints são os mesmos vértices no espaço da câmera (antes da
+    // projeção em perspectiva): a normal da luz sai deles e a luz parte da
+    // origem. Sem eles a normal sai de points e a luz vem de -z, como na
+    // projeção ortográfica. Faces de costas não são desenhadas.
+    void draw(const vertexArray& points, const std::vector<triangle>& faces, Framebuffer& fb,
+              const vertexArray* lightPoints = nullptr){
+        resize(fb.width, fb.height);
+        int count = (int)faces.size();
+        setups.resize(count);
+
+        // Fase 1: preparo e distribuição nos blocos
+        for(auto& threadBins : bins)
+            for(auto& bin : threadBins)
+                bin.clear();
+        int chunks = (count + setupChunk - 1) / setupChunk;
+        pool.run(chunks, [&](int chunk, int thread){
+            int end = std::min(count, (chunk + 1) * setupChunk);
+            for(int i = chunk * setupChunk; i < end; i++)
+                if(setup(points, lightPoints, faces[i], setups[i]))
+                    bin(i, thread);
+        });
+
+        // Fase 2: rasterização de cada bloco
+        pool.run(tilesX * tilesY, [&](int tile, int thread){
+            rasterizeTile(tile, thread, fb);
+        });
+    }
+
+private:
+    // Triângulo pronto para rasterizar: funções de aresta w = a*x + b*y + c
+    // (positivas dentro), plano de profundidade e caixa na tela. As funções
+    // não são divididas pela área: numa aresta comum a dois triângulos elas
+    // dão valores exatamente opostos, e a regra topo-esquerda não deixa
+    // frestas nem pixels desenhados duas vezes.
+    struct setupTriangle{
+        float a[3], b[3], c[3];
+        float zA, zB, zC;      // z = zA*x + zB*y + zC
+        float minZ;            // Profundidade mais próxima, para ordenar
+        bool topLeft[3];       // Aresta de topo ou esquerda: inclui w == 0
+        int minX, minY, maxX, maxY;
+        uint32_t color;
+    };
+
+    void resize(int width, int height){
+        if(width == fbWidth && height == fbHeight && (int)bins.size() == pool.size())
+            return;
+        fbWidth = width;
+        fbHeight = height;
+        tilesX = (width + tileSize - 1) / tileSize;
+        tilesY = (height + tileSize - 1) / tileSize;
+        depth.assign((size_t)width * height, 0);
+        bins.assign(pool.size(), std::vector<std::vector<int>>(tilesX * tilesY));
+        order.assign(pool.size(), {});
+    }
+
+    bool setup(const vertexArray& p, const vertexArray* lightPoints, const triangle& t, setupTriangle& s) const {
+        float x0 = p.x[t.a], y0 = p.y[t.a], z0 = p.z[t.a];
+        float x1 = p.x[t.b], y1 = p.y[t.b], z1 = p.z[t.b];
+        float x2 = p.x[t.c], y2 = p.y[t.c], z2 = p.z[t.c];
+
+        // Área com sinal: negativa para faces voltadas para a câmera (sentido
+        // anti-horário na tela com y para baixo). Zero ou positiva: descarta.
+        float area = (x1 - x0) * (y2 - y0) - (y1 - y0) * (x2 - x0);
+        if(!(area < 0))
+            return false;
+
+        // Caixa na tela, recortada
+        s.minX = std::max(0, (int)std::floor(std::min({x0, x1, x2})));
+        s.minY = std::max(0, (int)std::floor(std::min({y0, y1, y2})));
+        s.maxX = std::min(fbWidth - 1, (int)std::ceil(std::max({x0, x1, x2})));
+        s.maxY = std::min(fbHeight - 1, (int)std::ceil(std::max({y0, y1, y2})));
+        if(s.minX > s.maxX || s.minY > s.maxY)
+            return false;
+
+        // Funções de aresta, positivas dentro do triângulo (a área é negativa)
+        const float xs[3] = {x0, x1, x2}, ys[3] = {y0, y1, y2}, zs[3] = {z0, z1, z2};
+        for(int e = 0; e < 3; e++){
+            // Aresta oposta ao vértice e: de (j) para (k)
+            int j = (e + 1) % 3, k = (e + 2) % 3;
+            s.a[e] = ys[k] - ys[j];
+            s.b[e] = xs[j] - xs[k];
+            s.c[e] = xs[k] * ys[j] - xs[j] * ys[k];
+            // Com w crescendo para dentro e y para baixo, a aresta é esquerda
+            // se o interior fica à direita (a > 0) e de topo se é horizontal
+            // com o interior abaixo (a == 0, b > 0).
+            s.topLeft[e] = s.a[e] > 0 || (s.a[e] == 0 && s.b[e] > 0);
+        }
+        // Divididas pela área, as funções são as coordenadas baricêntricas
+        // (somam 1), que interpolam a profundidade.
+        float inv = -1.0f / area;
+        s.zA = (s.a[0] * z0 + s.a[1] * z1 + s.a[2] * z2) * inv;
+        s.zB = (s.b[0] * z0 + s.b[1] * z1 + s.b[2] * z2) * inv;
+        s.zC = (s.c[0] * z0 + s.c[1] * z1 + s.c[2] * z2) * inv;
+        s.minZ = std::min({zs[0], zs[1], zs[2]});
+
+        // Sombreamento plano: luz vinda da câmera, mais uma luz ambiente. A
+        // normal sai de posições com x, y e z na mesma escala
+        const vertexArray& l = lightPoints ? *lightPoints : p;
+        float ux = l.x[t.b] - l.x[t.a], uy = l.y[t.b] - l.y[t.a], uz = l.z[t.b] - l.z[t.a];
+        float vx = l.x[t.c] - l.x[t.a], vy = l.y[t.c] - l.y[t.a], vz = l.z[t.c] - l.z[t.a];
+        float nx = uy * vz - uz * vy;
+        float ny = uz * vx - ux * vz;
+        float nz = ux * vy - uy * vx;
+        float len = std::sqrt(nx * nx + ny * ny + nz * nz);
+        float facing = len > 0 ? -nz / len : 0;
+        if(lightPoints){
+            // Direção da câmera (na origem) até o primeiro vértice
+            float ax = l.x[t.a], ay = l.y[t.a], az = l.z[t.a];
+            float dist = std::sqrt(ax * ax + ay * ay + az * az);
+            facing = len > 0 && dist > 0 ? -(nx * ax + ny * ay + nz * az) / (len * dist) : 0;
+        }
+        float light = 0.2f + 0.8f * facing;
+        uint32_t level = (uint32_t)(std::min(std::max(light, 0.0f), 1.0f) * 255);
+        s.color = 0xFF000000 | level << 16 | level << 8 | level;
+        return true;
+    }
+
+    void bin(int index, int thread){
+        const setupTriangle& s = setups[index];
+        for(int ty = s.minY / tileSize; ty <= s.maxY / tileSize; ty++)
+            for(int tx = s.minX / tileSize; tx <= s.maxX / tileSize; tx++)
+                bins[thread][ty * tilesX + tx].push_back(index);
+    }
+
+    // Regra topo-esquerda: um pixel sobre a aresta só pertence ao triângulo
+    // se ela for de topo ou esquerda.
+    static bool inside(float w, bool topLeft){
+        return w > 0 || (w == 0 && topLeft);
+    }
+
+    void rasterizeTile(int tile, int thread, Framebuffer& fb){
+        int tx0 = (tile % tilesX) * tileSize, ty0 = (tile / tilesX) * tileSize;
+        int tx1 = std::min(tx0 + tileSize, fbWidth) - 1, ty1 = std::min(ty0 + tileSize, fbHeight) - 1;
+
+        // Limpa a profundidade do bloco (a cor é limpa pelo Framebuffer)
+        for(int y = ty0; y <= ty1; y++)
+            std::fill(&depth[(size_t)y * fbWidth + tx0], &depth[(size_t)y * fbWidth + tx1] + 1,
+                      std::numeric_limits<float>::infinity());
+
+        // Junta as listas de todas as threads e ordena da frente para trás.
+        // Que thread distribuiu cada triângulo muda de uma execução para
+        // outra, então os empates de profundidade são decididos pelo índice.
+        // (stable_sort, com a mesma ordem total, foi bem mais rápido que
+        // sort nestas listas no --bench-fill.)
+        std::vector<int>& list = order[thread];
+        list.clear();
+        for(auto& threadBins : bins)
+            list.insert(list.end(), threadBins[tile].begin(), threadBins[tile].end());
+        std::stable_sort(list.begin(), list.end(), [&](int l, int r){
+            return setups[l].minZ < setups[r].minZ || (setups[l].minZ == setups[r].minZ && l < r);
+        });
+
+        for(int index : list){
+            const setupTriangle& s = setups[index];
+            int x0 = std::max(s.minX, tx0), x1 = std::min(s.maxX, tx1);
+            int y0 = std::max(s.minY, ty0), y1 = std::min(s.maxY, ty1);
+            for(int y = y0; y <= y1; y++){
+                // As funções de aresta são avaliadas em cada pixel, não
+                // somando a: a soma acumularia erros diferentes nos dois
+                // triângulos de uma aresta, que começam em x diferentes.
+                float py = y + 0.5f;
+                float r0 = s.b[0] * py + s.c[0];
+                float r1 = s.b[1] * py + s.c[1];
+                float r2 = s.b[2] * py + s.c[2];
+                float z = s.zA * (x0 + 0.5f) + s.zB * py + s.zC;
+                float* d = &depth[(size_t)y * fbWidth];
+                uint32_t* c = &fb.pixels[(size_t)y * fbWidth];
+                for(int x = x0; x <= x1; x++){
+                    float px = x + 0.5f;
+                    float w0 = s.a[0] * px + r0;
+                    float w1 = s.a[1] * px + r1;
+                    float w2 = s.a[2] * px + r2;
+                    if(inside(w0, s.topLeft[0]) && inside(w1, s.topLeft[1]) && inside(w2, s.topLeft[2]) &&
+                       z < d[x]){
+                        d[x] = z;
+                        c[x] = s.color;
+                    }
+                    z += s.zA;
+                }
+            }
+        }
+    }
+
+    threadPool pool;
+    int fbWidth = 0, fbHeight = 0;
+    int tilesX = 0, tilesY = 0;
+    std::vector<float> depth;
+    std::vector<setupTriangle> setups;
+    std::vector<std::vector<std::vector<int>>> bins; // [thread][bloco] -> triângulos
+    std::vector<std::vector<int>> order;             // Lista de trabalho de cada thread
+};
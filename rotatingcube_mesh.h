@@ -0,0 +1,435 @@
+#pragma once
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define MESH_HAS_SSE 1
+#include <immintrin.h> // Intrínsecos SSE
+#else
+#define MESH_HAS_SSE 0
+#endif
+
+// Estrutura que representa um ponto tridimensional
+struct vec3{
+    float x,y,z;
+};
+
+// Estrutura que representa uma conexão entre dois pontos
+struct connection{
+    int a,b; // Índices dos dois pontos conectados
+};
+
+// Estrutura que representa um triângulo (índices dos três pontos). Como no
+// OBJ, os vértices de uma face voltada para a câmera aparecem na tela no
+// sentido anti-horário.
+struct triangle{
+    int a,b,c;
+};
+
+// Matriz 3x3 de rotação, linha a linha
+struct mat3{
+    float m[9];
+
+    // Rotação em torno de X, depois de Y e depois de Z (Rz * Ry * Rx), com a
+    // mesma convenção de sinais de rotate(). Os senos e cossenos são
+    // calculados uma vez por frame, não por vértice.
+    static mat3 rotation(float x, float y, float z){
+        float cx = std::cos(x), sx = std::sin(x);
+        float cy = std::cos(y), sy = std::sin(y);
+        float cz = std::cos(z), sz = std::sin(z);
+        return {{
+            cz * cy, -cz * sy * sx - sz * cx, -cz * sy * cx + sz * sx,
+            sz * cy, -sz * sy * sx + cz * cx, -sz * sy * cx - cz * sx,
+            sy,      cy * sx,                 cy * cx
+        }};
+    }
+};
+
+// Vértices em estrutura de arrays: um vetor por coordenada, para que o
+// transform leia e escreva 4 vértices por instrução SIMD.
+struct vertexArray{
+    std::vector<float> x, y, z;
+
+    size_t size() const { return x.size(); }
+
+    void resize(size_t n){
+        x.resize(n);
+        y.resize(n);
+        z.resize(n);
+    }
+
+    void push_back(const vec3& p){
+        x.push_back(p.x);
+        y.push_back(p.y);
+        z.push_back(p.z);
+    }
+};
+
+// Malha: a pose de repouso (centrada na origem, nunca alterada), a posição
+// do centro na tela, as arestas sem repetição e as faces em triângulos.
+struct mesh{
+    vertexArray rest;
+    vec3 center{0,0,0};
+    std::vector<connection> connections;
+    std::vector<triangle> faces;
+    std::vector<int> edgeFaces;  // Duas faces vizinhas de cada aresta (-1 se não houver)
+    static const int nonManifold = -2; // Marca em edgeFaces de aresta com mais de duas faces
+    std::vector<int> loosePoints; // Vértices que não estão em nenhuma aresta
+    float radius = 0;            // Raio da esfera envolvente em torno do centro
+
+    // Monta a malha a partir de pontos na posição da tela: o centro de massa
+    // vira a origem da pose de repouso.
+    void assign(const std::vector<vec3>& points, const std::vector<connection>& edges,
+                const std::vector<triangle>& triangles = {}){
+        center = {0,0,0};
+        for(auto& p : points){
+            center.x += p.x;
+            center.y += p.y;
+            center.z += p.z;
+        }
+        if(!points.empty()){
+            center.x /= points.size();
+            center.y /= points.size();
+            center.z /= points.size();
+        }
+        rest = vertexArray();
+        for(auto& p : points)
+            rest.push_back({p.x - center.x, p.y - center.y, p.z - center.z});
+        connections = edges;
+        faces = triangles;
+        buildTopology();
+    }
+
+    // Liga cada aresta às faces que a contêm (para descartar arestas entre
+    // faces de costas), acha os vértices soltos e mede o raio envolvente.
+    void buildTopology(){
+        std::vector<std::pair<uint64_t, int>> keys(connections.size());
+        for(size_t i = 0; i < connections.size(); i++)
+            keys[i] = {edgeKey(connections[i].a, connections[i].b), (int)i};
+        std::sort(keys.begin(), keys.end());
+
+        edgeFaces.assign(connections.size() * 2, -1);
+        for(size_t f = 0; f < faces.size(); f++){
+            const int v[3] = {faces[f].a, faces[f].b, faces[f].c};
+            for(int e = 0; e < 3; e++){
+                uint64_t key = edgeKey(v[e], v[(e + 1) % 3]);
+                auto it = std::lower_bound(keys.begin(), keys.end(), std::make_pair(key, -1));
+                if(it == keys.end() || it->first != key)
+                    continue; // Diagonal de um polígono dividido: não é aresta desenhada
+                int* slots = &edgeFaces[it->second * 2];
+                if(slots[0] == nonManifold) continue;
+                if(slots[0] < 0) slots[0] = (int)f;
+                else if(slots[1] < 0) slots[1] = (int)f;
+                else slots[0] = slots[1] = nonManifold; // Três ou mais faces: sempre desenhada
+            }
+        }
+
+        std::vector<bool> used(rest.size(), false);
+        for(auto& conn : connections)
+            used[conn.a] = used[conn.b] = true;
+        loosePoints.clear();
+        for(size_t i = 0; i < rest.size(); i++)
+            if(!used[i])
+                loosePoints.push_back((int)i);
+
+        updateRadius();
+    }
+
+    void updateRadius(){
+        float r2 = 0;
+        for(size_t i = 0; i < rest.size(); i++)
+            r2 = std::max(r2, rest.x[i] * rest.x[i] + rest.y[i] * rest.y[i] + rest.z[i] * rest.z[i]);
+        radius = std::sqrt(r2);
+    }
+
+    // Chave de uma aresta sem direção: o menor índice nos 32 bits altos
+    static uint64_t edgeKey(int a, int b){
+        return (uint64_t)(uint32_t)std::min(a, b) << 32 | (uint32_t)std::max(a, b);
+    }
+
+    // Centraliza a pose de repouso e a escala para caber num raio de
+    // "radius" pixels em torno de "target".
+    void fit(vec3 target, float radius){
+        size_t n = rest.size();
+        if(n == 0)
+            return;
+        vec3 lo{rest.x[0], rest.y[0], rest.z[0]}, hi = lo;
+        for(size_t i = 0; i < n; i++){
+            lo.x = std::min(lo.x, rest.x[i]); hi.x = std::max(hi.x, rest.x[i]);
+            lo.y = std::min(lo.y, rest.y[i]); hi.y = std::max(hi.y, rest.y[i]);
+            lo.z = std::min(lo.z, rest.z[i]); hi.z = std::max(hi.z, rest.z[i]);
+        }
+        vec3 mid{(lo.x + hi.x) / 2, (lo.y + hi.y) / 2, (lo.z + hi.z) / 2};
+        float extent = 0;
+        for(size_t i = 0; i < n; i++){
+            float dx = rest.x[i] - mid.x, dy = rest.y[i] - mid.y, dz = rest.z[i] - mid.z;
+            extent = std::max(extent, dx * dx + dy * dy + dz * dz);
+        }
+        float scale = extent > 0 ? radius / std::sqrt(extent) : 1.0f;
+        for(size_t i = 0; i < n; i++){
+            rest.x[i] = (rest.x[i] - mid.x) * scale;
+            rest.y[i] = (rest.y[i] - mid.y) * scale;
+            rest.z[i] = (rest.z[i] - mid.z) * scale;
+        }
+        center = target;
+        updateRadius();
+    }
+};
+
+// Aplica a rotação à pose de repouso e soma o centro: out = m * rest + center.
+// Versão escalar, de referência.
+inline void transformScalar(const mat3& m, const vertexArray& rest, vec3 center, vertexArray& out){
+    size_t n = rest.size();
+    out.resize(n);
+    for(size_t i = 0; i < n; i++){
+        float x = rest.x[i], y = rest.y[i], z = rest.z[i];
+        out.x[i] = m.m[0] * x + m.m[1] * y + m.m[2] * z + center.x;
+        out.y[i] = m.m[3] * x + m.m[4] * y + m.m[5] * z + center.y;
+        out.z[i] = m.m[6] * x + m.m[7] * y + m.m[8] * z + center.z;
+    }
+}
+
+// Mesmo cálculo, 4 vértices por vez com SSE (o resto vai pelo caminho escalar).
+inline void transform(const mat3& m, const vertexArray& rest, vec3 center, vertexArray& out){
+#if MESH_HAS_SSE
+    size_t n = rest.size();
+    out.resize(n);
+    __m128 r[9];
+    for(int k = 0; k < 9; k++)
+        r[k] = _mm_set1_ps(m.m[k]);
+    __m128 cx = _mm_set1_ps(center.x), cy = _mm_set1_ps(center.y), cz = _mm_set1_ps(center.z);
+    size_t i = 0;
+    for(; i + 4 <= n; i += 4){
+        __m128 x = _mm_loadu_ps(&rest.x[i]);
+        __m128 y = _mm_loadu_ps(&rest.y[i]);
+        __m128 z = _mm_loadu_ps(&rest.z[i]);
+        _mm_storeu_ps(&out.x[i], _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(r[0], x), _mm_mul_ps(r[1], y)), _mm_mul_ps(r[2], z)), cx));
+        _mm_storeu_ps(&out.y[i], _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(r[3], x), _mm_mul_ps(r[4], y)), _mm_mul_ps(r[5], z)), cy));
+        _mm_storeu_ps(&out.z[i], _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(r[6], x), _mm_mul_ps(r[7], y)), _mm_mul_ps(r[8], z)), cz));
+    }
+    for(; i < n; i++){
+        float x = rest.x[i], y = rest.y[i], z = rest.z[i];
+        out.x[i] = m.m[0] * x + m.m[1] * y + m.m[2] * z + center.x;
+        out.y[i] = m.m[3] * x + m.m[4] * y + m.m[5] * z + center.y;
+        out.z[i] = m.m[6] * x + m.m[7] * y + m.m[8] * z + center.z;
+    }
+#else
+    transformScalar(m, rest, center, out);
+#endif
+}
+
+// Acrescenta as arestas de um polígono (a-b, b-c, ..., último-primeiro) ou,
+// se "closed" for false, de uma linha aberta (sem a aresta de volta).
+inline void addPolygonEdges(const std::vector<int>& face, std::vector<connection>& edges, bool closed = true){
+    if(face.size() < 2)
+        return;
+    size_t count = closed && face.size() > 2 ? face.size() : face.size() - 1;
+    for(size_t i = 0; i < count; i++){
+        int a = face[i];
+        int b = face[(i + 1) % face.size()];
+        if(a != b)
+            edges.push_back({a, b});
+    }
+}
+
+// Divide um polígono convexo em triângulos em leque (a-b-c, a-c-d, ...).
+inline void addPolygonTriangles(const std::vector<int>& face, std::vector<triangle>& triangles){
+    for(size_t i = 2; i < face.size(); i++)
+        triangles.push_back({face[0], face[i - 1], face[i]});
+}
+
+// Remove arestas repetidas (a-b e b-a contam como a mesma): cada aresta vira
+// uma chave de 64 bits com o menor índice primeiro, e as chaves são ordenadas.
+inline void removeDuplicateEdges(std::vector<connection>& edges){
+    std::vector<uint64_t> keys(edges.size());
+    for(size_t i = 0; i < edges.size(); i++)
+        keys[i] = mesh::edgeKey(edges[i].a, edges[i].b);
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+    edges.resize(keys.size());
+    for(size_t i = 0; i < keys.size(); i++)
+        edges[i] = {(int)(keys[i] >> 32), (int)(keys[i] & 0xFFFFFFFF)};
+}
+
+// Lê o arquivo inteiro para a memória
+inline bool readFile(const std::string& path, std::string& data, std::string& error){
+    FILE* f = std::fopen(path.c_str(), "rb");
+    if(!f){
+        error = "não foi possível abrir " + path;
+        return false;
+    }
+    std::fseek(f, 0, SEEK_END);
+    long size = std::ftell(f);
+    std::fseek(f, 0, SEEK_SET);
+    data.resize(size > 0 ? (size_t)size : 0);
+    size_t read = std::fread(&data[0], 1, data.size(), f);
+    std::fclose(f);
+    data.resize(read);
+    return true;
+}
+
+// Carrega um OBJ: usa as linhas "v" (vértices), "f" (faces) e "l" (linhas).
+// Índices negativos contam a partir do último vértice lido.
+inline bool loadObj(const std::string& data, std::vector<vec3>& points, std::vector<connection>& edges,
+                    std::vector<triangle>& triangles, std::string& error){
+    std::vector<int> face;
+    const char* p = data.c_str();
+    const char* end = p + data.size();
+    int lineNumber = 0;
+    while(p < end){
+        const char* eol = (const char*)std::memchr(p, '\n', end - p);
+        if(!eol)
+            eol = end;
+        lineNumber++;
+        std::string line(p, eol);
+        p = eol + 1;
+
+        const char* s = line.c_str();
+        while(*s == ' ' || *s == '\t')
+            s++;
+        if(s[0] == 'v' && (s[1] == ' ' || s[1] == '\t')){
+            vec3 v{0,0,0};
+            if(std::sscanf(s + 2, "%f %f %f", &v.x, &v.y, &v.z) != 3){
+                error = "linha " + std::to_string(lineNumber) + ": vértice inválido";
+                return false;
+            }
+            points.push_back(v);
+        }
+        else if((s[0] == 'f' || s[0] == 'l') && (s[1] == ' ' || s[1] == '\t')){
+            face.clear();
+            char* q = (char*)s + 2;
+            while(true){
+                char* next;
+                long index = std::strtol(q, &next, 10);
+                if(next == q)
+                    break;
+                // Pula "/vt/vn" depois do índice do vértice
+                while(*next && *next != ' ' && *next != '\t' && *next != '\r')
+                    next++;
+                q = next;
+                long resolved = index < 0 ? (long)points.size() + index : index - 1;
+                if(resolved < 0 || resolved >= (long)points.size()){
+                    error = "linha " + std::to_string(lineNumber) + ": índice de vértice fora do intervalo";
+                    return false;
+                }
+                face.push_back((int)resolved);
+            }
+            addPolygonEdges(face, edges, s[0] == 'f');
+            if(s[0] == 'f')
+                addPolygonTriangles(face, triangles);
+        }
+    }
+    return true;
+}
+
+// Carrega um PLY em ASCII: o cabeçalho diz quantos vértices e faces há; as
+// três primeiras propriedades de cada vértice são x, y e z.
+inline bool loadPly(const std::string& data, std::vector<vec3>& points, std::vector<connection>& edges,
+                    std::vector<triangle>& triangles, std::string& error){
+    const char* p = data.c_str();
+    const char* end = p + data.size();
+    auto nextLine = [&](std::string& line){
+        if(p >= end)
+            return false;
+        const char* eol = (const char*)std::memchr(p, '\n', end - p);
+        if(!eol)
+            eol = end;
+        line.assign(p, eol);
+        if(!line.empty() && line.back() == '\r')
+            line.pop_back();
+        p = eol + 1;
+        return true;
+    };
+
+    std::string line;
+    long vertexCount = 0, faceCount = 0;
+    bool ascii = false;
+    while(nextLine(line)){
+        if(line.compare(0, 6, "format") == 0)
+            ascii = line.find("ascii") != std::string::npos;
+        else if(line.compare(0, 14, "element vertex") == 0)
+            vertexCount = std::atol(line.c_str() + 14);
+        else if(line.compare(0, 12, "element face") == 0)
+            faceCount = std::atol(line.c_str() + 12);
+        else if(line == "end_header")
+            break;
+    }
+    if(!ascii){
+        error = "só PLY em ASCII é suportado";
+        return false;
+    }
+
+    points.reserve(vertexCount);
+    for(long i = 0; i < vertexCount; i++){
+        vec3 v{0,0,0};
+        if(!nextLine(line) || std::sscanf(line.c_str(), "%f %f %f", &v.x, &v.y, &v.z) != 3){
+            error = "vértice " + std::to_string(i) + " inválido";
+            return false;
+        }
+        points.push_back(v);
+    }
+
+    std::vector<int> face;
+    for(long i = 0; i < faceCount; i++){
+        if(!nextLine(line)){
+            error = "faltam faces no arquivo";
+            return false;
+        }
+        char* q = (char*)line.c_str();
+        long count = std::strtol(q, &q, 10);
+        face.clear();
+        for(long k = 0; k < count; k++){
+            long index = std::strtol(q, &q, 10);
+            if(index < 0 || index >= vertexCount){
+                error = "face " + std::to_string(i) + ": índice de vértice fora do intervalo";
+                return false;
+            }
+            face.push_back((int)index);
+        }
+        addPolygonEdges(face, edges);
+        addPolygonTriangles(face, triangles);
+    }
+    return true;
+}
+
+// Carrega uma malha OBJ ou PLY (pela extensão) e monta a lista de arestas sem
+// repetição. Retorna false e preenche "error" se falhar.
+inline bool loadMesh(const std::string& path, mesh& out, std::string& error){
+    std::string data;
+    if(!readFile(path, data, error))
+        return false;
+
+    std::vector<vec3> points;
+    std::vector<connection> edges;
+    std::vector<triangle> triangles;
+    std::string ext = path.size() >= 4 ? path.substr(path.size() - 4) : "";
+    for(auto& c : ext)
+        c = (char)std::tolower((unsigned char)c);
+    bool ok = ext == ".ply" ? loadPly(data, points, edges, triangles, error)
+                            : loadObj(data, points, edges, triangles, error);
+    if(!ok)
+        return false;
+    if(points.empty()){
+        error = "nenhum vértice em " + path;
+        return false;
+    }
+    removeDuplicateEdges(edges);
+    // Os arquivos usam y para cima e z para fora da tela; na tela y cresce
+    // para baixo e z para dentro. Girar 180 graus em torno de x mantém o
+    // sentido das faces, então as voltadas para fora continuam corretas.
+    for(auto& p : points){
+        p.y = -p.y;
+        p.z = -p.z;
+    }
+    out.assign(points, edges, triangles);
+    return true;
+}
@@ -0,0 +1,163 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// Framebuffer na CPU: um pixel ARGB8888 por posição, linha a linha. O frame é
+// desenhado aqui e enviado de uma vez para uma textura do SDL.
+struct Framebuffer{
+    int width = 0;
+    int height = 0;
+    std::vector<uint32_t> pixels;
+
+    Framebuffer(int w, int h) : width(w), height(h), pixels((size_t)w * h, 0) {}
+
+    // Pinta o frame inteiro com uma cor
+    void clear(uint32_t color){
+        std::fill(pixels.begin(), pixels.end(), color);
+    }
+
+    // Grava o frame em PPM binário (P6), RGB sem o canal alfa
+    bool savePPM(const std::string& path) const {
+        FILE* f = std::fopen(path.c_str(), "wb");
+        if(!f)
+            return false;
+        std::fprintf(f, "P6\n%d %d\n255\n", width, height);
+        std::vector<unsigned char> row((size_t)width * 3);
+        for(int y = 0; y < height; y++){
+            const uint32_t* p = &pixels[(size_t)y * width];
+            for(int x = 0; x < width; x++){
+                row[3 * x] = (unsigned char)(p[x] >> 16);
+                row[3 * x + 1] = (unsigned char)(p[x] >> 8);
+                row[3 * x + 2] = (unsigned char)p[x];
+            }
+            std::fwrite(row.data(), 1, row.size(), f);
+        }
+        return std::fclose(f) == 0;
+    }
+
+    // Hash FNV-1a de 64 bits dos pixels, para comparar frames entre execuções
+    uint64_t hash() const {
+        uint64_t h = 14695981039346656037ull;
+        for(uint32_t p : pixels){
+            for(int b = 0; b < 4; b++){
+                h ^= (p >> (8 * b)) & 0xFF;
+                h *= 1099511628211ull;
+            }
+        }
+        return h;
+    }
+
+    // Pinta um pixel, ignorando os que estão fora da tela
+    void pixel(int x, int y, uint32_t color){
+        if(x < 0 || y < 0 || x >= width || y >= height)
+            return;
+        pixels[(size_t)y * width + x] = color;
+    }
+
+    // Desenha uma linha. As pontas são recortadas contra a tela antes e o
+    // traçado é feito com Bresenham em inteiros, sem seno e cosseno por pixel.
+    void line(float x1, float y1, float x2, float y2, uint32_t color){
+        if(!clipLine(x1, y1, x2, y2))
+            return;
+        bresenham((int)std::lround(x1), (int)std::lround(y1), (int)std::lround(x2), (int)std::lround(y2), color);
+    }
+
+    // Bresenham com as duas pontas já dentro da tela
+    void bresenham(int x0, int y0, int x1, int y1, uint32_t color){
+        int dx = std::abs(x1 - x0);
+        int dy = -std::abs(y1 - y0);
+        int sx = x0 < x1 ? 1 : -1;
+        int sy = y0 < y1 ? width : -width; // Passo em y já convertido em deslocamento no buffer
+        int stepY = y0 < y1 ? 1 : -1;
+        int err = dx + dy;
+        uint32_t* p = &pixels[(size_t)y0 * width + x0];
+        while(true){
+            *p = color;
+            if(x0 == x1 && y0 == y1)
+                break;
+            int e2 = 2 * err;
+            if(e2 >= dy){
+                err += dy;
+                x0 += sx;
+                p += sx;
+            }
+            if(e2 <= dx){
+                err += dx;
+                y0 += stepY;
+                p += sy;
+            }
+        }
+    }
+
+private:
+    // Código de região de Cohen-Sutherland: em que lado da tela o ponto está
+    enum { INSIDE = 0, LEFT = 1, RIGHT = 2, TOP = 4, BOTTOM = 8 };
+
+    int outCode(float x, float y) const {
+        int code = INSIDE;
+        if(x < 0) code |= LEFT;
+        else if(x > width - 1) code |= RIGHT;
+        if(y < 0) code |= TOP;
+        else if(y > height - 1) code |= BOTTOM;
+        return code;
+    }
+
+    // Recorta a linha contra a tela (Cohen-Sutherland). Retorna false se ela
+    // estiver inteira do lado de fora.
+    bool clipLine(float& x1, float& y1, float& x2, float& y2) const {
+        if(!std::isfinite(x1) || !std::isfinite(y1) || !std::isfinite(x2) || !std::isfinite(y2))
+            return false;
+        float xMax = (float)(width - 1);
+        float yMax = (float)(height - 1);
+        int code1 = outCode(x1, y1);
+        int code2 = outCode(x2, y2);
+        // Cada ponta é movida no máximo duas vezes; o limite só evita que
+        // erros de arredondamento num canto façam o laço alternar para sempre
+        for(int i = 0; i < 4; i++){
+            if(!(code1 | code2))
+                return true; // As duas pontas dentro
+            if(code1 & code2)
+                return false; // As duas do mesmo lado de fora
+
+            // Move a ponta que está fora até a borda que ela ultrapassa
+            int code = code1 ? code1 : code2;
+            float x, y;
+            if(code & BOTTOM){
+                x = x1 + (x2 - x1) * (yMax - y1) / (y2 - y1);
+                y = yMax;
+            }
+            else if(code & TOP){
+                x = x1 + (x2 - x1) * (0 - y1) / (y2 - y1);
+                y = 0;
+            }
+            else if(code & RIGHT){
+                y = y1 + (y2 - y1) * (xMax - x1) / (x2 - x1);
+                x = xMax;
+            }
+            else{
+                y = y1 + (y2 - y1) * (0 - x1) / (x2 - x1);
+                x = 0;
+            }
+            if(code == code1){
+                x1 = x; y1 = y;
+                code1 = outCode(x1, y1);
+            }
+            else{
+                x2 = x; y2 = y;
+                code2 = outCode(x2, y2);
+            }
+        }
+        if(code1 & code2)
+            return false;
+        x1 = std::min(std::max(x1, 0.0f), xMax);
+        y1 = std::min(std::max(y1, 0.0f), yMax);
+        x2 = std::min(std::max(x2, 0.0f), xMax);
+        y2 = std::min(std::max(y2, 0.0f), yMax);
+        return true;
+    }
+};
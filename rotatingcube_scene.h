@@ -0,0 +1,281 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "rotatingcube_mesh.h"   // mesh, vertexArray e mat3
+#include "rotatingcube_raster.h" // Framebuffer
+#include "rotatingcube_fill.h"   // triangleRenderer
+
+// Câmera em perspectiva alinhada aos eixos da tela: x para a direita, y para
+// baixo e olhando para +z. Com a posição padrão de screenCamera(), um ponto
+// em z = 0 aparece no mesmo pixel da projeção ortográfica de antes.
+struct camera{
+    vec3 position{0,0,0};
+    float focal = 1;          // Distância focal em pixels
+    float centerX = 0, centerY = 0;
+    float tanX = 1, tanY = 1; // Meia largura e meia altura do campo de visão em z = 1
+    float nearZ = 1, farZ = 1;
+
+    // Câmera para uma tela de width x height com campo de visão vertical
+    // "fovY" (radianos), recuada até que o plano z = 0 ocupe a tela inteira.
+    static camera screenCamera(int width, int height, float fovY = 1.0471976f, float nearZ = 10, float farZ = 20000){
+        camera c;
+        c.centerX = width / 2.0f;
+        c.centerY = height / 2.0f;
+        c.focal = c.centerY / std::tan(fovY / 2);
+        c.tanX = c.centerX / c.focal;
+        c.tanY = c.centerY / c.focal;
+        c.position = {c.centerX, c.centerY, -c.focal};
+        c.nearZ = nearZ;
+        c.farZ = farZ;
+        return c;
+    }
+};
+
+// Tronco de visão em espaço de câmera: seis planos com a normal para dentro.
+struct frustum{
+    struct plane{
+        float x, y, z, d; // Dentro quando x*px + y*py + z*pz + d >= 0
+        float distance(vec3 p) const { return x * p.x + y * p.y + z * p.z + d; }
+    };
+    plane planes[6];
+
+    explicit frustum(const camera& c){
+        float lx = 1 / std::sqrt(1 + c.tanX * c.tanX);
+        float ly = 1 / std::sqrt(1 + c.tanY * c.tanY);
+        planes[0] = { lx, 0, c.tanX * lx, 0};  // Esquerda
+        planes[1] = {-lx, 0, c.tanX * lx, 0};  // Direita
+        planes[2] = {0,  ly, c.tanY * ly, 0};  // Cima
+        planes[3] = {0, -ly, c.tanY * ly, 0};  // Baixo
+        planes[4] = {0, 0,  1, -c.nearZ};      // Perto
+        planes[5] = {0, 0, -1,  c.farZ};       // Longe
+    }
+
+    // Esfera inteiramente fora de algum plano: objeto invisível
+    bool sphereVisible(vec3 center, float radius) const {
+        for(auto& p : planes)
+            if(p.distance(center) < -radius)
+                return false;
+        return true;
+    }
+};
+
+// Uma instância de malha na cena: posição do centro e ângulos de rotação
+struct sceneObject{
+    const mesh* model = nullptr;
+    vec3 position{0,0,0};
+    vec3 angles{0,0,0};
+};
+
+// Contadores do último frame, para comparar o que foi descartado
+struct cullStats{
+    int objects = 0, visibleObjects = 0;
+    size_t edges = 0, drawnEdges = 0, backEdges = 0, clippedEdges = 0;
+    size_t triangles = 0; // Triângulos enviados ao preenchimento
+};
+
+// Desenha uma cena de malhas em perspectiva com um estágio de descarte antes
+// da rasterização:
+//  - objetos cuja esfera envolvente está fora do tronco de visão são
+//    descartados inteiros, sem transformar nenhum vértice;
+//  - arestas cujas faces vizinhas estão todas de costas não são desenhadas
+//    (arestas sem faces, como as de linhas do OBJ, sempre são);
+//  - linhas e triângulos que cruzam o plano perto são cortados nele antes
+//    de projetar;
+//  - só os vértices soltos (fora de qualquer aresta) são desenhados como
+//    pontos, os outros já aparecem nas pontas das linhas.
+// Com culling = false, tudo o que está à frente da câmera é desenhado, para
+// medir o ganho do descarte.
+class sceneRenderer{
+public:
+    bool culling = true;
+    cullStats stats;
+
+    // Arestas em arame
+    void drawEdges(const camera& cam, const std::vector<sceneObject>& objects, Framebuffer& fb, uint32_t color){
+        stats = cullStats();
+        stats.objects = (int)objects.size();
+        frustum planes(cam);
+        for(auto& object : objects){
+            const mesh& m = *object.model;
+            stats.edges += m.connections.size();
+            vec3 center = toView(cam, object.position);
+            if(culling && !planes.sphereVisible(center, m.radius))
+                continue;
+            stats.visibleObjects++;
+
+            // Uma única transformação leva a pose de repouso para o espaço da câmera
+            transform(mat3::rotation(object.angles.x, object.angles.y, object.angles.z), m.rest, center, view);
+            project(cam, view, screen);
+            // Esfera toda além do plano perto: nenhuma aresta precisa de corte
+            bool crossesNear = !culling || planes.planes[4].distance(center) < m.radius;
+
+            if(culling)
+                faceOrientation(m);
+            for(size_t e = 0; e < m.connections.size(); e++){
+                if(culling && facesAway(m, e)){
+                    stats.backEdges++;
+                    continue;
+                }
+                int a = m.connections[e].a, b = m.connections[e].b;
+                if(!crossesNear || (view.z[a] >= cam.nearZ && view.z[b] >= cam.nearZ)){
+                    fb.line(screen.x[a], screen.y[a], screen.x[b], screen.y[b], color);
+                    stats.drawnEdges++;
+                }
+                else if(clipNear(cam, a, b, fb, color)){
+                    stats.clippedEdges++;
+                    stats.drawnEdges++;
+                }
+            }
+            for(int i : m.loosePoints)
+                if(view.z[i] >= cam.nearZ)
+                    fb.pixel((int)std::lround(screen.x[i]), (int)std::lround(screen.y[i]), color);
+        }
+    }
+
+    // Faces preenchidas: os objetos visíveis são juntados numa única chamada
+    // ao triangleRenderer, que já descarta as faces de costas. Triângulos que
+    // cruzam o plano perto são cortados nele, virando um ou dois triângulos;
+    // os que estão inteiros atrás dele são descartados.
+    void drawFaces(const camera& cam, const std::vector<sceneObject>& objects, Framebuffer& fb, triangleRenderer& renderer){
+        stats = cullStats();
+        stats.objects = (int)objects.size();
+        frustum planes(cam);
+        allPoints.resize(0);
+        allView.resize(0);
+        allFaces.clear();
+        for(auto& object : objects){
+            const mesh& m = *object.model;
+            vec3 center = toView(cam, object.position);
+            if(culling && !planes.sphereVisible(center, m.radius))
+                continue;
+            stats.visibleObjects++;
+
+            transform(mat3::rotation(object.angles.x, object.angles.y, object.angles.z), m.rest, center, view);
+            project(cam, view, screen);
+            bool crossesNear = !culling || planes.planes[4].distance(center) < m.radius;
+            // x, y na tela e profundidade -near/z: como 1/z, varia linearmente
+            // na tela depois da divisão pela perspectiva, e fica perto de zero
+            // (com precisão de sobra no float) para objetos distantes. A luz
+            // usa os vértices no espaço da câmera.
+            int base = (int)allPoints.size();
+            for(size_t i = 0; i < screen.size(); i++){
+                allPoints.push_back({screen.x[i], screen.y[i], -cam.nearZ / screen.z[i]});
+                allView.push_back({view.x[i], view.y[i], view.z[i]});
+            }
+            for(auto& t : m.faces){
+                if(!crossesNear || (view.z[t.a] >= cam.nearZ && view.z[t.b] >= cam.nearZ && view.z[t.c] >= cam.nearZ))
+                    allFaces.push_back({t.a + base, t.b + base, t.c + base});
+                else
+                    clipFaceNear(cam, t, base);
+            }
+        }
+        stats.triangles = allFaces.size();
+        renderer.draw(allPoints, allFaces, fb, &allView);
+    }
+
+private:
+    static vec3 toView(const camera& cam, vec3 p){
+        return {p.x - cam.position.x, p.y - cam.position.y, p.z - cam.position.z};
+    }
+
+    // Projeção em perspectiva; pontos atrás do plano perto ficam com NaN
+    static void project(const camera& cam, const vertexArray& in, vertexArray& out){
+        size_t n = in.size();
+        out.resize(n);
+        const float nan = std::numeric_limits<float>::quiet_NaN();
+        for(size_t i = 0; i < n; i++){
+            float z = in.z[i];
+            float inv = z >= cam.nearZ ? cam.focal / z : nan;
+            out.x[i] = cam.centerX + in.x[i] * inv;
+            out.y[i] = cam.centerY + in.y[i] * inv;
+            out.z[i] = z;
+        }
+    }
+
+    // Marca as faces voltadas para a câmera (na origem do espaço de câmera):
+    // a normal aponta para longe do raio que vai da câmera ao vértice.
+    void faceOrientation(const mesh& m){
+        front.resize(m.faces.size());
+        for(size_t f = 0; f < m.faces.size(); f++){
+            const triangle& t = m.faces[f];
+            float ax = view.x[t.a], ay = view.y[t.a], az = view.z[t.a];
+            float ux = view.x[t.b] - ax, uy = view.y[t.b] - ay, uz = view.z[t.b] - az;
+            float vx = view.x[t.c] - ax, vy = view.y[t.c] - ay, vz = view.z[t.c] - az;
+            float nx = uy * vz - uz * vy;
+            float ny = uz * vx - ux * vz;
+            float nz = ux * vy - uy * vx;
+            front[f] = nx * ax + ny * ay + nz * az < 0;
+        }
+    }
+
+    // Aresta com faces vizinhas, todas de costas
+    bool facesAway(const mesh& m, size_t e) const {
+        int f0 = m.edgeFaces[2 * e], f1 = m.edgeFaces[2 * e + 1];
+        if(f0 < 0)
+            return false; // Sem faces (ou com mais de duas)
+        return !front[f0] && (f1 < 0 || !front[f1]);
+    }
+
+    // Corta a aresta a-b no plano perto e desenha a parte da frente
+    bool clipNear(const camera& cam, int a, int b, Framebuffer& fb, uint32_t color) const {
+        float za = view.z[a], zb = view.z[b];
+        if(za < cam.nearZ && zb < cam.nearZ)
+            return false;
+        if(za < cam.nearZ)
+            std::swap(a, b), std::swap(za, zb);
+        // a está na frente, b atrás: ponto de b-a em que z = near
+        float t = (cam.nearZ - za) / (zb - za);
+        float x = view.x[a] + (view.x[b] - view.x[a]) * t;
+        float y = view.y[a] + (view.y[b] - view.y[a]) * t;
+        float inv = cam.focal / cam.nearZ;
+        fb.line(screen.x[a], screen.y[a], cam.centerX + x * inv, cam.centerY + y * inv, color);
+        return true;
+    }
+
+    // Corta o triângulo t do objeto atual no plano perto (Sutherland-Hodgman
+    // com um só plano). Os vértices da frente são reaproveitados e os pontos
+    // de corte acrescentados a allPoints e allView; sai um triângulo (um
+    // vértice na frente) ou dois (dois na frente), na mesma orientação de t.
+    void clipFaceNear(const camera& cam, const triangle& t, int base){
+        const int in[3] = {t.a, t.b, t.c};
+        int out[4], count = 0;
+        for(int i = 0; i < 3; i++){
+            int a = in[i], b = in[(i + 1) % 3];
+            bool aFront = view.z[a] >= cam.nearZ, bFront = view.z[b] >= cam.nearZ;
+            if(aFront)
+                out[count++] = a + base;
+            if(aFront != bFront)
+                out[count++] = aFront ? nearPoint(cam, a, b) : nearPoint(cam, b, a);
+        }
+        if(count >= 3)
+            allFaces.push_back({out[0], out[1], out[2]});
+        if(count == 4)
+            allFaces.push_back({out[0], out[2], out[3]});
+    }
+
+    // Ponto da aresta entre a (na frente) e b (atrás) em que z = near, já
+    // projetado. Calculado sempre de a para b, como em clipNear, para que as
+    // duas faces de uma aresta cortada cheguem exatamente ao mesmo ponto.
+    int nearPoint(const camera& cam, int a, int b){
+        float za = view.z[a], zb = view.z[b];
+        float t = (cam.nearZ - za) / (zb - za);
+        float x = view.x[a] + (view.x[b] - view.x[a]) * t;
+        float y = view.y[a] + (view.y[b] - view.y[a]) * t;
+        float inv = cam.focal / cam.nearZ;
+        allPoints.push_back({cam.centerX + x * inv, cam.centerY + y * inv, -1});
+        allView.push_back({x, y, cam.nearZ});
+        return (int)allPoints.size() - 1;
+    }
+
+    vertexArray view;             // Vértices do objeto atual no espaço da câmera
+    vertexArray screen;           // Os mesmos, projetados (z continua o da câmera)
+    std::vector<char> front;      // Face voltada para a câmera, por face
+    vertexArray allPoints;        // Vértices projetados de todos os objetos (preenchimento)
+    vertexArray allView;          // Os mesmos no espaço da câmera, para a luz
+    std::vector<triangle> allFaces;
+};
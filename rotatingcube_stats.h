@@ -0,0 +1,53 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+// Tempos de frame de uma execução, em milissegundos, com percentis por
+// ordenação (método do posto mais próximo).
+struct frameStats{
+    std::vector<double> ms;
+
+    void add(double frameMs){
+        ms.push_back(frameMs);
+    }
+
+    double percentile(double p) const {
+        if(ms.empty())
+            return 0;
+        std::vector<double> sorted = ms;
+        std::sort(sorted.begin(), sorted.end());
+        return sorted[(size_t)(p / 100 * (sorted.size() - 1) + 0.5)];
+    }
+
+    double total() const {
+        double sum = 0;
+        for(double f : ms)
+            sum += f;
+        return sum;
+    }
+
+    double mean() const {
+        return ms.empty() ? 0 : total() / ms.size();
+    }
+
+    // Desvio padrão: o jitter, quando os valores são intervalos entre frames
+    double stddev() const {
+        if(ms.size() < 2)
+            return 0;
+        double m = mean(), sum = 0;
+        for(double f : ms)
+            sum += (f - m) * (f - m);
+        return std::sqrt(sum / (ms.size() - 1));
+    }
+
+    // Uma linha com média, mínimo, percentis e máximo
+    void print(const char* label) const {
+        double m = mean();
+        std::printf("%s: %zu frames, média %.3f ms (%.1f FPS), mín %.3f, p50 %.3f, p95 %.3f, p99 %.3f, máx %.3f ms\n",
+                    label, ms.size(), m, m > 0 ? 1000 / m : 0, percentile(0), percentile(50),
+                    percentile(95), percentile(99), percentile(100));
+    }
+};
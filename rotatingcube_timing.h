@@ -0,0 +1,81 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+// Como o loop principal espera entre um frame e outro
+enum class paceMode{
+    uncapped, // Sem espera: o próximo frame começa assim que o anterior termina
+    target,   // Frames a cada 1/fps segundos, com espera mista (dorme e depois gira)
+    vsync     // A espera fica com SDL_RenderPresent, no retraço do monitor
+};
+
+// Acumulador de passo fixo: o tempo real de cada frame entra no acumulador
+// e sai em passos de "step" segundos, então a velocidade da animação não
+// depende da taxa de frames nem da carga da máquina. A sobra (alpha, entre
+// 0 e 1) é usada para interpolar entre os dois últimos estados simulados.
+class fixedTimestep{
+public:
+    explicit fixedTimestep(double step, int maxSteps = 8) : step(step), maxSteps(maxSteps) {}
+
+    // Soma o tempo do frame e retorna quantos passos simular. Se a máquina
+    // não der conta, o atraso além de maxSteps passos é descartado, em vez
+    // de crescer a cada frame.
+    int advance(double seconds){
+        accumulator += seconds;
+        int steps = (int)(accumulator / step);
+        if(steps > maxSteps){
+            steps = maxSteps;
+            accumulator = 0;
+        }
+        else{
+            accumulator -= steps * step;
+        }
+        return steps;
+    }
+
+    double alpha() const { return accumulator / step; }
+
+    const double step; // Segundos simulados por passo
+
+private:
+    int maxSteps;
+    double accumulator = 0;
+};
+
+// Espera do modo paceMode::target. Os prazos são absolutos (cada um é o
+// anterior mais o período), para que os erros de uma espera não se somem nas
+// seguintes. O sleep do sistema pode acordar atrasado, então a thread dorme
+// só até spinMargin antes do prazo e gira o resto, lendo o relógio.
+class framePacer{
+public:
+    using clock = std::chrono::steady_clock;
+
+    framePacer(paceMode mode, double fps) : mode(mode), period(std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(1.0 / std::max(fps, 1.0)))) {}
+
+    // Chamado no fim de cada frame
+    void wait(){
+        if(mode != paceMode::target)
+            return;
+        clock::time_point now = clock::now();
+        if(next == clock::time_point() || now > next + period){
+            // Primeiro frame ou atraso de mais de um período: recomeça do agora
+            next = now + period;
+        }
+        else{
+            next += period;
+        }
+        if(next - now > spinMargin)
+            std::this_thread::sleep_until(next - spinMargin);
+        while(clock::now() < next)
+            std::this_thread::yield();
+    }
+
+    static constexpr std::chrono::microseconds spinMargin{1500};
+
+private:
+    paceMode mode;
+    clock::duration period;
+    clock::time_point next;
+};
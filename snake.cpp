@@ -1,100 +1,50 @@
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <time.h>
 #include <raylib.h>
-#include <deque>
 #include <raymath.h>
 
+#include "snake_autopilot.h" // Campo de distâncias incremental e ciclo hamiltoniano
+#include "snake_batch.h" // Partidas sem tela em paralelo, com políticas
+#include "snake_input.h" // Fila de curvas com horário e ticks de tamanho fixo
+#include "snake_render.h" // Camadas estáticas e corpo desenhado num lote só
+#include "snake_sim.h"   // Regras da cobra sem raylib
+
 using namespace std;
 
 // Definição das cores usadas no jogo
 Color green = {173, 204, 96, 255};
 Color darkGreen = {43, 51, 24, 255};
 
-// Tamanho da célula e quantidade de células no grid
-const int cellSize = 30;
-const int cellCount = 25;
+// Tamanho da célula e quantidade de células no grid (--cells N muda o
+// grid e encolhe as células para a janela continuar do mesmo tamanho)
+int cellSize = 30;
+int cellCount = 25;
 const int offset = 75;
 
-// Variável para controlar o tempo da última atualização
-double lastUpdateTime = 0.0;
-
-// Função para verificar se um elemento está na deque
-bool ElementInDeque(Vector2 element, const deque<Vector2>& dq){
-    for(const auto& item : dq){
-        if(Vector2Equals(item, element))
-            return true;
-    }
-    return false;
-}
-
-// Função para verificar se um evento foi acionado com base no intervalo de tempo
-bool eventTriggered(double interval){
-    double currentTime = GetTime();
-    if(currentTime - lastUpdateTime >= interval){
-        lastUpdateTime = currentTime;
-        return true;
-    }
-    return false;
-}
-
-// Classe representando a cobra
-class Snake{
-public:
-    deque<Vector2> body = { Vector2{6,9}, Vector2{5,9}, Vector2{4,9} };
-    Vector2 direction = {1, 0}; // Direção inicial: direita
-    bool addSegment = false;
-
-    // Função para desenhar a cobra na tela
-    void Draw(){
-        for(const auto& segmentPos : body){
-            float x = segmentPos.x;
-            float y = segmentPos.y;
-            Rectangle segment = Rectangle{ offset + x * cellSize, offset + y * cellSize, (float)cellSize, (float)cellSize };
-            DrawRectangleRounded(segment, 0.5f, 6, darkGreen);
-        }
-    }
-
-    // Função para atualizar a posição da cobra
-    void Update(){
-        // Calcula a nova cabeça com base na direção
-        Vector2 newHead = Vector2Add(body.front(), direction);
-        body.push_front(newHead);
-        
-        if (addSegment){
-            // Se for para adicionar um segmento, não remove a cauda
-            addSegment = false;
-        }
-        else {
-            // Remove a cauda para manter o tamanho
-            body.pop_back();
-        }
-    }
+// Segundos por tick do jogo (--tick muda)
+double tickInterval = 0.2;
 
-    // Função para resetar a cobra para o estado inicial
-    void Reset(){
-        body = { Vector2{6,9}, Vector2{5,9}, Vector2{4,9} };
-        direction = {1, 0};
-    }
-};
-
-// Classe representando a comida
+// Classe representando a comida: só a textura e o desenho. A posição fica
+// em SnakeSim::food.
 class Food{
 public:
-    Vector2 position;
     Texture2D texture;
 
-    // Construtor que carrega a textura da comida e gera uma posição inicial
-    Food(const deque<Vector2>& snakeBody){
+    // Construtor que carrega a textura da comida
+    Food(){
         Image image = LoadImage("Graphics/food.png");
         if (image.data == NULL){
             // Se a imagem não for carregada, usa um retângulo simples vermelho
             UnloadImage(image);
-            texture = LoadTexture(GenImageColor(cellSize, cellSize, RED));
-        }
-        else{
-            texture = LoadTextureFromImage(image);
-            UnloadImage(image);
+            image = GenImageColor(cellSize, cellSize, RED);
         }
-        position = GenerateRandomPos(snakeBody);
+        texture = LoadTextureFromImage(image);
+        UnloadImage(image);
     }
 
     // Destrutor que descarrega a textura
@@ -102,97 +52,172 @@ public:
         UnloadTexture(texture);
     }
 
-    // Função para desenhar a comida na tela
-    void Draw(){
-        DrawTexture(texture, offset + (int)(position.x * cellSize), offset + (int)(position.y * cellSize), WHITE);
-    }
-
-    // Gera uma célula aleatória dentro do grid
-    Vector2 GenerateRandomCell(){
-        float x = (float)GetRandomValue(0, cellCount - 1);
-        float y = (float)GetRandomValue(0, cellCount - 1);
-        return Vector2{ x, y };
-    }
-
-    // Gera uma posição aleatória que não está ocupada pela cobra
-    Vector2 GenerateRandomPos(const deque<Vector2>& snakeBody){
-        Vector2 pos = GenerateRandomCell();
-        while(ElementInDeque(pos, snakeBody)){
-            pos = GenerateRandomCell();
-        }
-        return pos;
+    // Função para desenhar a comida na célula cell (a textura é esticada
+    // para o tamanho da célula)
+    void Draw(const Board& grid, int cell){
+        if(cell < 0)
+            return;
+        Rectangle source = { 0, 0, (float)texture.width, (float)texture.height };
+        Rectangle dest = { (float)(offset + grid.X(cell) * cellSize), (float)(offset + grid.Y(cell) * cellSize), (float)cellSize, (float)cellSize };
+        DrawTexturePro(texture, source, dest, Vector2{ 0, 0 }, 0.0f, WHITE);
     }
 };
 
-// Classe representando o jogo
+// Classe representando o jogo: as regras (SnakeSim) e o desenho
 class Game{
 public:
-    Snake snake;
+    SnakeSim sim;
     Food food;
-    bool running;
-    int score;
+    SnakeRenderer renderer;
 
-    // Construtor
-    Game() : snake(), food(snake.body), running(true), score(0) {}
+    // Construtor (depois de InitWindow: carrega texturas)
+    Game(int cells, uint64_t seed) : sim(cells, seed), food(), renderer(cellSize, cells, offset, green, darkGreen) {}
+
+    // Prepara as camadas que mudam (a pontuação). Fora de BeginDrawing.
+    void Prepare(){
+        renderer.UpdateScore(sim.score);
+    }
 
     // Função para desenhar os elementos do jogo
     void Draw(){
-        food.Draw();
-        snake.Draw();
+        renderer.DrawBackground();
+        food.Draw(sim.grid, sim.food);
+        renderer.DrawSnake(sim.grid, sim.body);
     }
 
     // Função para atualizar o estado do jogo
     void Update(){
-        if(running){
-            snake.Update();
-            CheckCollisionWithFood();
-            CheckCollisionWithEdges();
-            CheckCollisionWithTail();
-        }
+        sim.Update();
     }
 
-    // Verifica colisão com a comida
-    void CheckCollisionWithFood(){
-        if(Vector2Equals(snake.body.front(), food.position)){
-            snake.addSegment = true;
-            score++;
-            // Reposiciona a comida
-            food.position = food.GenerateRandomPos(snake.body);
+};
+
+// Mede um tick (andar, colisões e reposicionar a comida) com a cobra
+// ocupando uma fração do tabuleiro. A cobra anda em zigue-zague pelas
+// linhas, que nunca cruza o próprio corpo, e a comida é sorteada a cada tick
+// (o pior caso: comer em todos os ticks).
+void RunBoardBenchmark(){
+    const int ticks = 5000;
+    printf("%-10s %-10s %14s\n", "grid", "ocupação", "us/tick");
+    for(int cells : { 25, 100, 1000 }){
+        // Caminho em zigue-zague: linha par da esquerda para a direita, ímpar
+        // da direita para a esquerda
+        vector<int> path;
+        for(int y = 0; y < cells; y++)
+            for(int i = 0; i < cells; i++)
+                path.push_back(y * cells + (y % 2 == 0 ? i : cells - 1 - i));
+
+        for(double fill : { 0.1, 0.5, 0.9, 0.99 }){
+            int length = (int)(fill * cells * cells);
+            int steps = min(ticks, cells * cells - length);
+            if(length < 1 || steps < 1)
+                continue;
+
+            SnakeSim sim(cells, 1);
+            sim.grid.Clear();
+            sim.body.clear();
+            for(int i = 0; i < length; i++){
+                sim.body.push_front(path[i]);
+                sim.grid.Occupy(path[i]);
+            }
+
+            int collisions = 0, food = 0;
+            auto tp1 = chrono::steady_clock::now();
+            for(int i = 0; i < steps; i++){
+                int from = path[length + i - 1], to = path[length + i];
+                sim.Turn(sim.grid.X(to) - sim.grid.X(from), sim.grid.Y(to) - sim.grid.Y(from));
+                collisions += sim.Update();
+                food = sim.GenerateRandomPos();
+            }
+            auto tp2 = chrono::steady_clock::now();
+            double seconds = chrono::duration<double>(tp2 - tp1).count();
+            printf("%4dx%-5d %8.0f%% %14.3f%s\n", cells, cells, fill * 100, seconds / steps * 1e6,
+                   collisions || food < 0 ? "  (erro: colisão ou tabuleiro cheio)" : "");
         }
     }
+}
 
-    // Verifica colisão com as bordas do grid
-    void CheckCollisionWithEdges(){
-        Vector2 head = snake.body.front();
-        if(head.x >= cellCount || head.x < 0 || head.y >= cellCount || head.y < 0){
-            GameOver();
+// Joga milhares de partidas sem tela com cada política, em todos os
+// núcleos, e mostra partidas e ticks por segundo.
+void RunBatchBenchmark(int games){
+    int threads = max(1, (int)thread::hardware_concurrency());
+    SnakeBatch batch(threads);
+    printf("%d partidas por linha, %d threads\n", games, batch.ThreadCount());
+    printf("%-8s %-10s %12s %14s %10s %8s %8s\n", "política", "grid", "partidas/s", "ticks/s", "média", "máx", "cortadas");
+    struct Policy{ const char* name; SnakePolicyFactory make; };
+    Policy policies[] = {
+        { "random", [](int game){ return unique_ptr<SnakePolicy>(new RandomPolicy(1000003u * game)); } },
+        { "greedy", [](int){ return unique_ptr<SnakePolicy>(new GreedyPolicy()); } },
+    };
+    for(const Policy& policy : policies){
+        for(int cells : { 25, 100 }){
+            SnakeBatchResult r = batch.Run(games, cells, 1, 100000, policy.make);
+            printf("%-8s %4dx%-5d %12.0f %14.0f %10.2f %8d %8d\n", policy.name, cells, cells,
+                   r.GamesPerSecond(), r.TicksPerSecond(), r.MeanScore(), r.maxScore, r.timeouts);
         }
     }
+}
 
-    // Verifica colisão com o próprio corpo da cobra
-    void CheckCollisionWithTail(){
-        if(snake.body.size() < 2)
-            return; // Sem colisão possível
-
-        Vector2 head = snake.body.front();
-        for(auto it = snake.body.begin() + 1; it != snake.body.end(); ++it){
-            if(Vector2Equals(head, *it)){
-                GameOver();
-                break;
+// Mede o tempo de decisão do piloto automático por tick em grids cada vez
+// maiores: com o campo de distâncias atualizado aos poucos e refazendo a BFS
+// inteira a cada tick.
+void RunAutopilotBenchmark(){
+    printf("%-11s %-11s %8s %12s %10s %14s %8s\n", "grid", "campo", "ticks", "us/decisão", "refeitos", "células/tick", "comidas");
+    for(int cells : { 25, 100, 316, 1000 }){
+        for(bool incremental : { true, false }){
+            // A BFS inteira em 1000x1000 leva milissegundos: menos ticks
+            int ticks = incremental ? 20000 : max(200, 20000000 / (cells * cells));
+            SnakeSim sim(cells, 1);
+            Autopilot pilot(cells, cells);
+            pilot.incremental = incremental;
+            double seconds = 0.0;
+            int played = 0, deaths = 0;
+            for(; played < ticks; played++){
+                auto tp1 = chrono::steady_clock::now();
+                pilot.Decide(sim);
+                auto tp2 = chrono::steady_clock::now();
+                seconds += chrono::duration<double>(tp2 - tp1).count();
+                int score = sim.score;
+                if(sim.Update()){
+                    deaths++;
+                    printf("  morreu com %d comidas\n", score);
+                }
             }
+            printf("%4dx%-6d %-11s %8d %12.2f %10lld %14.1f %8d\n", cells, cells, incremental ? "incremental" : "do zero",
+                   played, seconds / played * 1e6, pilot.Rebuilds(), (double)pilot.Repaired() / played, sim.score);
         }
     }
+}
 
-    // Função para tratar o fim do jogo
-    void GameOver(){
-        snake.Reset();
-        food.position = food.GenerateRandomPos(snake.body);
-        running = false;
-        score = 0;
+int main(int argc, char* argv[]){
+    uint64_t seed = (uint64_t)time(NULL);
+    bool autopilot = false;
+    for(int i = 1; i < argc; i++){
+        if(strcmp(argv[i], "--bench-board") == 0){
+            RunBoardBenchmark();
+            return 0;
+        }
+        if(strcmp(argv[i], "--bench-batch") == 0){
+            RunBatchBenchmark(i + 1 < argc ? max(1, atoi(argv[i + 1])) : 10000);
+            return 0;
+        }
+        if(strcmp(argv[i], "--bench-autopilot") == 0){
+            RunAutopilotBenchmark();
+            return 0;
+        }
+        if(strcmp(argv[i], "--autopilot") == 0)
+            autopilot = true;
+        if(strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+            seed = strtoull(argv[++i], NULL, 10);
+        if(strcmp(argv[i], "--tick") == 0 && i + 1 < argc)
+            tickInterval = max(0.001, atof(argv[++i]));
+        if(strcmp(argv[i], "--cells") == 0 && i + 1 < argc){
+            // A cobra começa em (4..6, 9): o grid precisa de pelo menos 10 células
+            cellCount = max(10, atoi(argv[++i]));
+            cellSize = max(1, 750 / cellCount);
+        }
     }
-};
 
-int main(){
     printf("Iniciando o Jogo!...");
 
     // Inicializa a janela do jogo
@@ -200,49 +225,47 @@ int main(){
     SetTargetFPS(60);
 
     // Cria uma instância do jogo
-    Game game;
+    Game game(cellCount, seed);
+    InputQueue input;
+    TickScheduler ticks(tickInterval);
+    LatencyStats latency;
+    Autopilot pilot(cellCount, cellCount); // Usado com --autopilot
 
     // Loop principal do jogo
     while(!WindowShouldClose()){
-        // Atualiza a direção da cobra com base nas teclas pressionadas
-        if(IsKeyPressed(KEY_UP) && game.snake.direction.y != 1){
-            game.snake.direction = {0, -1};
-            game.running = true;
-        }
-        
-        if(IsKeyPressed(KEY_DOWN) && game.snake.direction.y != -1){
-            game.snake.direction = {0, 1};
-            game.running = true;
-        }
-        
-        if(IsKeyPressed(KEY_LEFT) && game.snake.direction.x != 1){
-            game.snake.direction = {-1, 0};
-            game.running = true;
-        }
-        
-        if(IsKeyPressed(KEY_RIGHT) && game.snake.direction.x != -1){
-            game.snake.direction = {1, 0};
-            game.running = true;
+        double now = GetTime();
+
+        // Enfileira todas as teclas lidas neste frame, na ordem em que foram
+        // pressionadas (a fila de teclas do raylib não junta dois toques)
+        int key;
+        while((key = GetKeyPressed()) != 0){
+            if(key == KEY_UP)
+                input.Push(0, -1, now, game.sim);
+            if(key == KEY_DOWN)
+                input.Push(0, 1, now, game.sim);
+            if(key == KEY_LEFT)
+                input.Push(-1, 0, now, game.sim);
+            if(key == KEY_RIGHT)
+                input.Push(1, 0, now, game.sim);
         }
 
-        // Atualiza o estado do jogo a cada intervalo de tempo
-        if(eventTriggered(0.2)){
+        // Roda os ticks vencidos, cada um com no máximo uma curva da fila
+        for(int n = ticks.Advance(now); n > 0; n--){
+            TurnRequest turn;
+            if(input.Pop(turn) && game.sim.Turn(turn.x, turn.y))
+                latency.Add(now - turn.time);
+            if(autopilot)
+                pilot.Decide(game.sim);
             game.Update();
         }
 
-        BeginDrawing();
-        
-        // Limpa o fundo
-        ClearBackground(green);
-
-        // Desenha a borda do grid
-        DrawRectangleLinesEx(Rectangle{ (float)offset - 5, (float)offset -5, (float)(cellSize * cellCount) + 10, (float)(cellSize * cellCount) + 10 }, 5, darkGreen);
+        // Redesenha a pontuação só se ela mudou
+        game.Prepare();
 
-        // Desenha o título e a pontuação
-        DrawText("Cobrazuda", offset -5, 20, 40, darkGreen);
-        DrawText(TextFormat("Pontuação: %i", game.score), offset -5, offset + cellSize * cellCount + 10, 40, darkGreen);
+        BeginDrawing();
 
-        // Desenha os elementos do jogo
+        // Desenha o fundo, a borda, o título e a pontuação (camadas prontas)
+        // e os elementos do jogo
         game.Draw();
 
         EndDrawing();
@@ -250,5 +273,8 @@ int main(){
 
     // Fecha a janela
     CloseWindow();
+    latency.Print("\nLatência tecla -> movimento");
+    if(input.Dropped())
+        printf("%d teclas descartadas com a fila cheia\n", input.Dropped());
     return 0;
 }
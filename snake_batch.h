@@ -0,0 +1,149 @@
+#pragma once
+
+// Roda milhares de partidas independentes da cobra sem tela, espalhadas
+// pelos núcleos, cada uma com a sua política (o "jogador") e a sua semente.
+// Serve para avaliar bots em escala e para pegar regressões de desempenho
+// nas regras: o resultado diz partidas por segundo e ticks por segundo.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "workers.h"   // Threads persistentes com roubo de trabalho
+#include "snake_sim.h" // Regras da cobra sem raylib
+
+using namespace std;
+
+// Decide a direção da cobra antes de cada tick, chamando sim.Turn.
+class SnakePolicy{
+public:
+    virtual ~SnakePolicy() {}
+    virtual void Decide(SnakeSim& sim) = 0;
+};
+
+// Cria a política da partida game (cada partida tem a sua, então a política
+// pode guardar estado sem sincronização).
+using SnakePolicyFactory = function<unique_ptr<SnakePolicy>(int game)>;
+
+const int snakeDirX[4] = { 1, 0, -1, 0 };
+const int snakeDirY[4] = { 0, 1, 0, -1 };
+
+// Sorteia entre as direções que não matam no próximo tick.
+class RandomPolicy : public SnakePolicy{
+public:
+    explicit RandomPolicy(uint64_t seed) : random(seed) {}
+
+    void Decide(SnakeSim& sim) override {
+        int hx = sim.grid.X(sim.Head()), hy = sim.grid.Y(sim.Head());
+        int options[4], count = 0;
+        for(int d = 0; d < 4; d++){
+            if(!sim.Blocked(hx + snakeDirX[d], hy + snakeDirY[d]))
+                options[count++] = d;
+        }
+        if(count > 0){
+            int d = options[random.Below(count)];
+            sim.Turn(snakeDirX[d], snakeDirY[d]);
+        }
+    }
+
+private:
+    SnakeRandom random;
+};
+
+// Vai para a direção segura que mais aproxima a cabeça da comida
+// (distância de Manhattan), sem olhar adiante.
+class GreedyPolicy : public SnakePolicy{
+public:
+    void Decide(SnakeSim& sim) override {
+        if(sim.food < 0)
+            return;
+        int hx = sim.grid.X(sim.Head()), hy = sim.grid.Y(sim.Head());
+        int fx = sim.grid.X(sim.food), fy = sim.grid.Y(sim.food);
+        int best = -1, bestDistance = 0;
+        for(int d = 0; d < 4; d++){
+            int x = hx + snakeDirX[d], y = hy + snakeDirY[d];
+            if(sim.Blocked(x, y))
+                continue;
+            int distance = abs(fx - x) + abs(fy - y);
+            if(best < 0 || distance < bestDistance){
+                best = d;
+                bestDistance = distance;
+            }
+        }
+        if(best >= 0)
+            sim.Turn(snakeDirX[best], snakeDirY[best]);
+    }
+};
+
+struct SnakeBatchResult{
+    int games = 0;
+    long long ticks = 0;     // Ticks somados de todas as partidas
+    long long totalScore = 0;
+    int maxScore = 0;
+    int timeouts = 0;        // Partidas cortadas em maxTicks
+    double seconds = 0.0;
+
+    double GamesPerSecond() const { return games / seconds; }
+    double TicksPerSecond() const { return ticks / seconds; }
+    double MeanScore() const { return games ? (double)totalScore / games : 0.0; }
+};
+
+class SnakeBatch{
+public:
+    explicit SnakeBatch(int threads) : workers(threads) {}
+
+    int ThreadCount() const { return workers.ThreadCount(); }
+
+    // Joga games partidas num grid de cells x cells, a partida i com a
+    // semente seed + i, até a cobra morrer ou até maxTicks ticks.
+    SnakeBatchResult Run(int games, int cells, uint64_t seed, int maxTicks, const SnakePolicyFactory& makePolicy){
+        vector<GameResult> results(games);
+        auto tp1 = chrono::steady_clock::now();
+        // Partidas têm durações bem diferentes: faixas pequenas para o roubo
+        // de trabalho equilibrar as threads
+        workers.Run(games, 8, [&](int g0, int g1){
+            for(int g = g0; g < g1; g++){
+                SnakeSim sim(cells, seed + g);
+                unique_ptr<SnakePolicy> policy = makePolicy(g);
+                GameResult& r = results[g];
+                r.timeout = true;
+                for(int t = 0; t < maxTicks; t++){
+                    policy->Decide(sim);
+                    int score = sim.score;
+                    r.ticks++;
+                    if(sim.Update()){
+                        r.score = score;
+                        r.timeout = false;
+                        break;
+                    }
+                }
+                if(r.timeout)
+                    r.score = sim.score;
+            }
+        });
+        auto tp2 = chrono::steady_clock::now();
+
+        SnakeBatchResult total;
+        total.games = games;
+        total.seconds = chrono::duration<double>(tp2 - tp1).count();
+        for(const GameResult& r : results){
+            total.ticks += r.ticks;
+            total.totalScore += r.score;
+            total.maxScore = max(total.maxScore, r.score);
+            total.timeouts += r.timeout;
+        }
+        return total;
+    }
+
+private:
+    struct GameResult{
+        long long ticks = 0;
+        int score = 0;
+        bool timeout = false;
+    };
+
+    WorkerPool workers;
+};
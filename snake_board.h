@@ -0,0 +1,114 @@
+#pragma once
+
+// Tabuleiro da cobra em índices inteiros de célula (y * largura + x), sem
+// Vector2 nem comparação de floats:
+//
+//  - Board guarda a ocupação do grid num bitset (um bit por célula) e a
+//    lista das células livres. Cada célula sabe sua posição na lista, então
+//    ocupar uma célula é trocar com a última e encolher a lista (O(1)), e
+//    sortear a comida é sortear uma posição da lista (O(1), sem tentativas).
+//  - SnakeBody guarda o corpo num buffer circular de índices com capacidade
+//    para o grid inteiro: andar é escrever a cabeça e avançar a cauda, sem
+//    alocar nada.
+//
+// Com isso as colisões e a comida custam o mesmo com 3 ou com 1 milhão de
+// segmentos.
+
+#include <cstdint>
+#include <vector>
+
+using namespace std;
+
+class Board{
+public:
+    Board(int width, int height) : width(width), height(height){
+        bits.resize(((size_t)width * height + 63) / 64);
+        freeCells.resize((size_t)width * height);
+        slot.resize((size_t)width * height);
+        Clear();
+    }
+
+    int Width() const { return width; }
+    int Height() const { return height; }
+    int Cells() const { return width * height; }
+
+    int Index(int x, int y) const { return y * width + x; }
+    int X(int cell) const { return cell % width; }
+    int Y(int cell) const { return cell / width; }
+    bool Inside(int x, int y) const { return x >= 0 && x < width && y >= 0 && y < height; }
+
+    bool Occupied(int cell) const { return (bits[cell >> 6] >> (cell & 63)) & 1; }
+
+    // Marca a célula como ocupada e a tira da lista de livres
+    void Occupy(int cell){
+        bits[cell >> 6] |= uint64_t(1) << (cell & 63);
+        int i = slot[cell];
+        int last = freeCells[--freeCount];
+        freeCells[i] = last;
+        slot[last] = i;
+    }
+
+    // Marca a célula como livre e a põe no fim da lista de livres
+    void Release(int cell){
+        bits[cell >> 6] &= ~(uint64_t(1) << (cell & 63));
+        slot[cell] = freeCount;
+        freeCells[freeCount++] = cell;
+    }
+
+    // Células livres, em ordem qualquer
+    int FreeCount() const { return freeCount; }
+    int FreeCell(int i) const { return freeCells[i]; }
+
+    // Esvazia o tabuleiro
+    void Clear(){
+        for(auto& word : bits)
+            word = 0;
+        for(int i = 0; i < Cells(); i++){
+            freeCells[i] = i;
+            slot[i] = i;
+        }
+        freeCount = Cells();
+    }
+
+private:
+    int width, height;
+    vector<uint64_t> bits;  // Ocupação, um bit por célula
+    vector<int> freeCells;  // [0, freeCount): células livres
+    vector<int> slot;       // Posição de cada célula livre em freeCells
+    int freeCount = 0;
+};
+
+// Corpo da cobra, da cabeça (índice 0) até a cauda. A interface imita a da
+// deque que era usada antes (front, back, size, push_front, pop_back).
+class SnakeBody{
+public:
+    explicit SnakeBody(int capacity) : ring(capacity) {}
+
+    int size() const { return count; }
+    int front() const { return ring[head]; }
+    int back() const { return (*this)[count - 1]; }
+
+    // i-ésimo segmento a partir da cabeça
+    int operator[](int i) const {
+        int k = head + i;
+        return ring[k >= (int)ring.size() ? k - (int)ring.size() : k];
+    }
+
+    void push_front(int cell){
+        head = head == 0 ? (int)ring.size() - 1 : head - 1;
+        ring[head] = cell;
+        count++;
+    }
+
+    void pop_back(){ count--; }
+
+    void clear(){
+        head = 0;
+        count = 0;
+    }
+
+private:
+    vector<int> ring;
+    int head = 0;
+    int count = 0;
+};
@@ -0,0 +1,133 @@
+#pragma once
+
+// Entrada e relógio da cobra separados do frame de desenho:
+//
+//  - InputQueue guarda as curvas na ordem em que as teclas foram lidas, com
+//    o instante de cada uma. Cada tick aplica no máximo uma curva, então dois
+//    toques rápidos entre dois ticks (baixo e esquerda, para fazer a volta)
+//    viram duas curvas em ticks seguidos, em vez de a segunda sobrescrever a
+//    primeira.
+//  - TickScheduler acumula o tempo real e diz quantos ticks de tamanho fixo
+//    rodar, sem depender de o frame cair exatamente no instante do tick.
+//  - LatencyStats mede o tempo entre a tecla e o tick que moveu a cobra
+//    naquela direção.
+
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+#include "snake_sim.h" // Regras da cobra sem raylib
+
+using namespace std;
+
+// Curva pedida e o instante (em segundos) em que a tecla foi lida
+struct TurnRequest{
+    int x, y;
+    double time;
+};
+
+class InputQueue{
+public:
+    static const int capacity = 4; // Curvas pendentes; além disso a tecla é descartada
+
+    // Enfileira a curva (x, y). Ignora a tecla se ela não mudaria nada
+    // depois das curvas já na fila: repetir a última direção ou pedir a
+    // oposta. Com a fila vazia compara com a direção atual da cobra (a
+    // direção atual com o jogo parado recomeça o jogo, então entra).
+    bool Push(int x, int y, double time, const SnakeSim& sim){
+        int lastX = sim.dirX, lastY = sim.dirY;
+        if(count > 0){
+            const TurnRequest& last = items[(first + count - 1) % capacity];
+            lastX = last.x;
+            lastY = last.y;
+        }
+        if(x == -lastX && y == -lastY)
+            return false;
+        if(x == lastX && y == lastY && (count > 0 || sim.running))
+            return false;
+        if(count == capacity){
+            dropped++;
+            return false;
+        }
+        items[(first + count) % capacity] = TurnRequest{ x, y, time };
+        count++;
+        return true;
+    }
+
+    // Tira a curva mais antiga
+    bool Pop(TurnRequest& request){
+        if(count == 0)
+            return false;
+        request = items[first];
+        first = (first + 1) % capacity;
+        count--;
+        return true;
+    }
+
+    int Size() const { return count; }
+    int Dropped() const { return dropped; }
+
+private:
+    TurnRequest items[capacity];
+    int first = 0;
+    int count = 0;
+    int dropped = 0;
+};
+
+class TickScheduler{
+public:
+    explicit TickScheduler(double step, int maxTicks = 5) : step(step), maxTicks(maxTicks) {}
+
+    double Step() const { return step; }
+
+    // Soma o tempo desde a última chamada e retorna quantos ticks rodar.
+    // Depois de uma pausa longa (janela arrastada, depurador) roda no
+    // máximo maxTicks e descarta o resto, em vez de acelerar o jogo.
+    int Advance(double now){
+        if(last < 0)
+            last = now;
+        accumulator += now - last;
+        last = now;
+        int ticks = 0;
+        while(accumulator >= step && ticks < maxTicks){
+            accumulator -= step;
+            ticks++;
+        }
+        if(ticks == maxTicks)
+            accumulator = min(accumulator, step);
+        return ticks;
+    }
+
+private:
+    double step;
+    int maxTicks;
+    double accumulator = 0.0;
+    double last = -1.0;
+};
+
+// Tempos entre a tecla e o movimento, em milissegundos
+struct LatencyStats{
+    vector<double> ms;
+
+    void Add(double seconds){
+        ms.push_back(seconds * 1000.0);
+    }
+
+    double Percentile(double p) const {
+        vector<double> sorted = ms;
+        sort(sorted.begin(), sorted.end());
+        return sorted[(size_t)(p / 100 * (sorted.size() - 1) + 0.5)];
+    }
+
+    void Print(const char* label) const {
+        if(ms.empty()){
+            printf("%s: nenhuma curva\n", label);
+            return;
+        }
+        double sum = 0;
+        for(double v : ms)
+            sum += v;
+        printf("%s: %zu curvas, média %.1f ms, p50 %.1f, p95 %.1f, máx %.1f ms\n",
+               label, ms.size(), sum / ms.size(), Percentile(50), Percentile(95), Percentile(100));
+    }
+};
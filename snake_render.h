@@ -0,0 +1,110 @@
+#pragma once
+
+// Desenho da cobra com custo fixo por frame:
+//
+//  - O fundo, a borda e o título nunca mudam: são desenhados uma vez numa
+//    RenderTexture2D e a cada frame só essa textura é copiada para a tela.
+//  - A pontuação fica numa textura própria, redesenhada só quando o valor
+//    muda.
+//  - O segmento arredondado é desenhado uma vez numa textura (um atlas de um
+//    quadro só) e o corpo inteiro vira um único lote de quads com essa
+//    textura, via rlgl, em vez de um DrawRectangleRounded (dezenas de
+//    triângulos) por segmento. O rlgl só quebra o lote quando o buffer de
+//    vértices enche.
+
+#include <raylib.h>
+#include <rlgl.h>
+
+#include "snake_board.h" // Ocupação do grid e corpo da cobra em índices inteiros
+
+class SnakeRenderer{
+public:
+    SnakeRenderer(int cellSize, int cellCount, int offset, Color background, Color foreground)
+        : cellSize(cellSize), cellCount(cellCount), offset(offset), background(background), foreground(foreground){
+        int side = 2 * offset + cellSize * cellCount;
+        int board = cellSize * cellCount;
+
+        // Camada estática: fundo, borda do grid e título
+        staticLayer = LoadRenderTexture(side, side);
+        BeginTextureMode(staticLayer);
+        ClearBackground(background);
+        DrawRectangleLinesEx(Rectangle{ (float)offset - 5, (float)offset - 5, (float)board + 10, (float)board + 10 }, 5, foreground);
+        DrawText("Cobrazuda", offset - 5, 20, 40, foreground);
+        EndTextureMode();
+
+        // Camada da pontuação, abaixo do grid (desenhada no primeiro UpdateScore)
+        scoreLayer = LoadRenderTexture(side - (offset - 5), 40);
+
+        // Segmento arredondado sobre fundo transparente
+        segment = LoadRenderTexture(cellSize, cellSize);
+        BeginTextureMode(segment);
+        ClearBackground(BLANK);
+        DrawRectangleRounded(Rectangle{ 0, 0, (float)cellSize, (float)cellSize }, 0.5f, 6, foreground);
+        EndTextureMode();
+    }
+
+    ~SnakeRenderer(){
+        UnloadRenderTexture(staticLayer);
+        UnloadRenderTexture(scoreLayer);
+        UnloadRenderTexture(segment);
+    }
+
+    SnakeRenderer(const SnakeRenderer&) = delete;
+    SnakeRenderer& operator=(const SnakeRenderer&) = delete;
+
+    // Redesenha a camada da pontuação se o valor mudou. Chamar fora de
+    // BeginDrawing/EndDrawing.
+    void UpdateScore(int score){
+        if(score == shownScore)
+            return;
+        shownScore = score;
+        BeginTextureMode(scoreLayer);
+        ClearBackground(background);
+        DrawText(TextFormat("Pontuação: %i", score), 0, 0, 40, foreground);
+        EndTextureMode();
+    }
+
+    // Copia as camadas prontas para a tela (substitui o ClearBackground)
+    void DrawBackground(){
+        DrawLayer(staticLayer, 0, 0);
+        DrawLayer(scoreLayer, offset - 5, offset + cellSize * cellCount + 10);
+    }
+
+    // Desenha o corpo inteiro num único lote de quads com a textura do
+    // segmento
+    void DrawSnake(const Board& grid, const SnakeBody& body){
+        rlSetTexture(segment.texture.id);
+        rlBegin(RL_QUADS);
+        rlColor4ub(255, 255, 255, 255);
+        rlNormal3f(0.0f, 0.0f, 1.0f);
+        float size = (float)cellSize;
+        for(int i = 0; i < body.size(); i++){
+            // Se o buffer de vértices encher, o rlgl desenha o lote atual e
+            // começa outro
+            rlCheckRenderBatchLimit(4);
+            float x = (float)(offset + grid.X(body[i]) * cellSize);
+            float y = (float)(offset + grid.Y(body[i]) * cellSize);
+            // A textura de um RenderTexture fica de cabeça para baixo: v invertido
+            rlTexCoord2f(0.0f, 1.0f); rlVertex2f(x, y);
+            rlTexCoord2f(0.0f, 0.0f); rlVertex2f(x, y + size);
+            rlTexCoord2f(1.0f, 0.0f); rlVertex2f(x + size, y + size);
+            rlTexCoord2f(1.0f, 1.0f); rlVertex2f(x + size, y);
+        }
+        rlEnd();
+        rlSetTexture(0);
+    }
+
+private:
+    // Desenha uma RenderTexture2D em (x, y), desvirando o eixo y
+    void DrawLayer(const RenderTexture2D& layer, int x, int y){
+        Rectangle source = { 0, 0, (float)layer.texture.width, -(float)layer.texture.height };
+        DrawTextureRec(layer.texture, source, Vector2{ (float)x, (float)y }, WHITE);
+    }
+
+    int cellSize, cellCount, offset;
+    Color background, foreground;
+    RenderTexture2D staticLayer;
+    RenderTexture2D scoreLayer;
+    RenderTexture2D segment;
+    int shownScore = -1;
+};
@@ -0,0 +1,177 @@
+#pragma once
+
+// Regras da cobra sem raylib: o estado do jogo, um tick e a comida sorteada
+// por um gerador com semente. Nada aqui abre janela, carrega textura ou lê o
+// relógio, então o jogo roda sem tela (em lote, em testes e em bots) e a
+// mesma semente com as mesmas curvas gera sempre a mesma partida.
+
+#include <cstdint>
+
+#include "snake_board.h" // Ocupação do grid e corpo da cobra em índices inteiros
+
+using namespace std;
+
+// Gerador xorshift64* com a semente espalhada por splitmix64 (sementes
+// vizinhas geram sequências sem relação).
+class SnakeRandom{
+public:
+    explicit SnakeRandom(uint64_t seed){
+        uint64_t z = seed + 0x9E3779B97F4A7C15ull;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        state = (z ^ (z >> 31)) | 1; // Nunca zero, que é ponto fixo
+    }
+
+    uint32_t Next(){
+        state ^= state >> 12;
+        state ^= state << 25;
+        state ^= state >> 27;
+        return (uint32_t)((state * 0x2545F4914F6CDD1Dull) >> 32);
+    }
+
+    // Inteiro em [0, n)
+    int Below(int n){ return (int)(((uint64_t)Next() * (uint32_t)n) >> 32); }
+
+private:
+    uint64_t state;
+};
+
+class SnakeSim{
+public:
+    Board grid;     // Células ocupadas pelo corpo e lista das livres
+    SnakeBody body; // Células do corpo, da cabeça à cauda
+    int dirX = 1, dirY = 0; // Direção inicial: direita
+    bool addSegment = false;
+    bool hitBody = false;   // A cabeça entrou numa célula do corpo no último tick
+    int food = -1;          // Célula da comida (-1: tabuleiro cheio)
+    bool running = true;    // Parado depois de perder, até a próxima curva
+    int score = 0;
+    SnakeRandom random;
+
+    SnakeSim(int cells, uint64_t seed) : grid(cells, cells), body(cells * cells), random(seed){
+        Reset();
+        food = GenerateRandomPos();
+    }
+
+    int Head() const { return body.front(); }
+
+    // Muda a direção e retoma o jogo. Para trás, que mataria a cobra na
+    // hora, é ignorado (e retorna false).
+    bool Turn(int x, int y){
+        if(x == -dirX && y == -dirY)
+            return false;
+        dirX = x;
+        dirY = y;
+        running = true;
+        return true;
+    }
+
+    // A cabeça morreria entrando em (x, y) no próximo tick? A cauda sai da
+    // célula dela antes, a não ser que a cobra esteja crescendo.
+    bool Blocked(int x, int y) const {
+        if(!grid.Inside(x, y))
+            return true;
+        int cell = grid.Index(x, y);
+        return grid.Occupied(cell) && (addSegment || cell != body.back());
+    }
+
+    // Avança um tick. Retorna true se a cobra morreu: o jogo volta ao
+    // começo, parado.
+    bool Update(){
+        if(!running)
+            return false;
+        int newHead;
+        if(CheckCollisionWithEdges(newHead))
+            return true;
+        Move(newHead);
+        if(CheckCollisionWithTail())
+            return true;
+        CheckCollisionWithFood();
+        return false;
+    }
+
+    // Verifica colisão com a comida
+    void CheckCollisionWithFood(){
+        if(body.front() == food){
+            addSegment = true;
+            score++;
+            // Reposiciona a comida
+            food = GenerateRandomPos();
+        }
+    }
+
+    // Verifica colisão com as bordas do grid antes de a cobra andar. Se a
+    // cabeça continua dentro, devolve em newHead a célula para onde ela vai.
+    bool CheckCollisionWithEdges(int& newHead){
+        int x = grid.X(body.front()) + dirX;
+        int y = grid.Y(body.front()) + dirY;
+        if(!grid.Inside(x, y)){
+            GameOver();
+            return true;
+        }
+        newHead = grid.Index(x, y);
+        return false;
+    }
+
+    // Verifica colisão com o próprio corpo da cobra: um bit do grid, em vez
+    // de percorrer o corpo inteiro
+    bool CheckCollisionWithTail(){
+        if(hitBody){
+            GameOver();
+            return true;
+        }
+        return false;
+    }
+
+    // Sorteia uma das células livres: uma posição da lista de livres, sem
+    // tentar de novo quando cai em cima da cobra. Com o tabuleiro cheio
+    // devolve -1.
+    int GenerateRandomPos(){
+        if(grid.FreeCount() == 0)
+            return -1;
+        return grid.FreeCell(random.Below(grid.FreeCount()));
+    }
+
+private:
+    // Anda a cobra para newHead (já conferida contra as bordas)
+    void Move(int newHead){
+        if (addSegment){
+            // Se for para adicionar um segmento, não remove a cauda
+            addSegment = false;
+        }
+        else {
+            // Remove a cauda para manter o tamanho (antes de olhar a cabeça:
+            // a cabeça pode entrar na célula que a cauda acabou de deixar)
+            grid.Release(body.back());
+            body.pop_back();
+        }
+
+        hitBody = grid.Occupied(newHead);
+        body.push_front(newHead);
+        if(!hitBody)
+            grid.Occupy(newHead);
+    }
+
+    // Volta a cobra para o estado inicial: três segmentos em (4..6, 9)
+    // andando para a direita. O grid precisa de pelo menos 10 células.
+    void Reset(){
+        grid.Clear();
+        body.clear();
+        for(int x = 4; x <= 6; x++){
+            body.push_front(grid.Index(x, 9));
+            grid.Occupy(grid.Index(x, 9));
+        }
+        dirX = 1;
+        dirY = 0;
+        addSegment = false;
+        hitBody = false;
+    }
+
+    // Função para tratar o fim do jogo
+    void GameOver(){
+        Reset();
+        food = GenerateRandomPos();
+        running = false;
+        score = 0;
+    }
+};
@@ -0,0 +1,138 @@
+#pragma once
+
+// Conjunto de threads com roubo de trabalho, usado pelos três programas: as
+// colunas da tela no consolefps e as partidas em lote no flappybird e no
+// snake.
+
+#include <atomic>              // Contadores atômicos das filas de trabalho.
+#include <condition_variable>  // Sinalização de início/fim de cada Run para as threads.
+#include <functional>          // std::function para o trabalho de cada faixa.
+#include <mutex>
+#include <thread>
+#include <vector>
+using namespace std;
+
+// Tamanho de uma linha de cache (alinhamento das filas e dos buffers que
+// threads diferentes escrevem).
+const int nCacheLineSize = 64;
+
+// Conjunto persistente de threads que processa os itens [0, nItems) em
+// paralelo. Os itens são divididos em faixas de nChunk e cada thread recebe
+// um intervalo contínuo de faixas. Quando termina as suas, rouba faixas das
+// outras threads, já que o custo por item varia (colunas com paredes
+// distantes, partidas que acabam cedo). A thread que chama Run() também
+// trabalha, então são criadas nThreads - 1 threads.
+class WorkerPool {
+public:
+    explicit WorkerPool(int nThreads) {
+        if (nThreads < 1)
+            nThreads = 1;
+        queues = vector<WorkerQueue>(nThreads);
+        for (int i = 1; i < nThreads; i++)
+            threads.emplace_back([this, i] { ThreadLoop(i); });
+    }
+
+    ~WorkerPool() {
+        {
+            lock_guard<mutex> lock(mtx);
+            bQuit = true;
+        }
+        cvStart.notify_all();
+        for (auto& t : threads)
+            t.join();
+    }
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    int ThreadCount() const { return (int)queues.size(); }
+
+    // Executa fn(i0, i1) para todas as faixas [i0, i1) de [0, nItems) e só
+    // retorna quando todas as faixas foram processadas.
+    void Run(int nItems, int nChunk, const function<void(int, int)>& fn) {
+        int nThreads = ThreadCount();
+        int nChunks = (nItems + nChunk - 1) / nChunk;
+
+        // Distribui as faixas em intervalos contínuos, um por thread.
+        for (int i = 0; i < nThreads; i++) {
+            queues[i].nNext.store(i * nChunks / nThreads, memory_order_relaxed);
+            queues[i].nEnd = (i + 1) * nChunks / nThreads;
+        }
+        pWork = &fn;
+        this->nItems = nItems;
+        this->nChunk = nChunk;
+
+        // Acorda as threads para o novo trabalho.
+        {
+            lock_guard<mutex> lock(mtx);
+            nPending = nThreads - 1;
+            nGeneration++;
+        }
+        cvStart.notify_all();
+
+        DrainQueues(0);
+
+        // Espera as outras threads terminarem as faixas que pegaram.
+        unique_lock<mutex> lock(mtx);
+        cvDone.wait(lock, [this] { return nPending == 0; });
+        pWork = nullptr;
+    }
+
+private:
+    // Fila de faixas de uma thread. Cada fila ocupa a sua própria linha de
+    // cache para que o contador de uma thread não invalide o das outras.
+    struct alignas(nCacheLineSize) WorkerQueue {
+        atomic<int> nNext{0};  // Próxima faixa a ser desenhada.
+        int nEnd = 0;          // Fim (exclusivo) do intervalo de faixas.
+    };
+
+    // Processa as faixas da própria fila e depois rouba das outras filas.
+    // Cada faixa é obtida com fetch_add, então é processada por uma única thread.
+    void DrainQueues(int nSelf) {
+        int nThreads = ThreadCount();
+        for (int k = 0; k < nThreads; k++) {
+            WorkerQueue& q = queues[(nSelf + k) % nThreads];
+            int c;
+            while ((c = q.nNext.fetch_add(1, memory_order_relaxed)) < q.nEnd) {
+                int i0 = c * nChunk;
+                int i1 = i0 + nChunk < nItems ? i0 + nChunk : nItems;
+                (*pWork)(i0, i1);
+            }
+        }
+    }
+
+    void ThreadLoop(int nSelf) {
+        long long nSeen = 0;
+        while (true) {
+            {
+                unique_lock<mutex> lock(mtx);
+                cvStart.wait(lock, [&] { return bQuit || nGeneration != nSeen; });
+                if (bQuit)
+                    return;
+                nSeen = nGeneration;
+            }
+
+            DrainQueues(nSelf);
+
+            {
+                lock_guard<mutex> lock(mtx);
+                if (--nPending == 0)
+                    cvDone.notify_one();
+            }
+        }
+    }
+
+    vector<WorkerQueue> queues;
+    vector<thread> threads;
+
+    const function<void(int, int)>* pWork = nullptr;  // Trabalho do Run atual.
+    int nItems = 0;
+    int nChunk = 1;
+
+    mutex mtx;
+    condition_variable cvStart;  // Sinaliza o início de um Run.
+    condition_variable cvDone;   // Sinaliza que todas as threads terminaram.
+    long long nGeneration = 0;   // Número do Run atual.
+    int nPending = 0;            // Threads que ainda não terminaram o Run.
+    bool bQuit = false;
+};